@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "hardware/timer.h"
@@ -7,10 +8,27 @@
 #include "pico/time.h"
 #include "hardware/i2c.h"
 #include "inc/ssd1306.h"
-#include "inc/font.h"
+#include "inc/ws2812_parallel.h"
+#include "inc/dlog.h"
+#include "inc/trace.h"
+#include "inc/latencia.h"
+#include "inc/entrada.h"
+#include "inc/historico.h"
+#include "inc/protocolo.h"
+#include "inc/governador.h"
+#include "inc/repouso.h"
+#include "inc/repeticao.h"
+#include "inc/grafico.h"
+#include "inc/barramento.h"
+#include "inc/bitmap.h"
+#include "inc/espelho.h"
+#if !PERFIL_INTEIRO
 #include <math.h> // Importa a função ceil() para arredondamento
+#endif
 #include "hardware/adc.h"
 #include "hardware/pwm.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
 
 // Definições para o display SSD1306 (comunicação I2C)
 #define I2C_PORT i2c1          // Porta I2C utilizada
@@ -21,8 +39,10 @@
 #define buttonA 5              // Pino do botão A
 #define buttonB 6              // Pino do botão B
 
-#define MATRIX_LED 7           // Pino da matriz de LEDs
+#define MATRIX_LED 7           // Pino da matriz de LEDs (primeira fita)
 #define NUM_PIXELS 25          // Número de LEDs na matriz (5x5)
+#define NUM_FITAS 1            // Número de matrizes/fitas, uma por estação, em pinos consecutivos a partir de MATRIX_LED
+#define ESTACAO_LOCAL 0        // Estação cujos níveis de ração e água são exibidos
 
 // Definição dos pinos do joystick
 #define analogicox 27          // Pino do eixo X do joystick (GPIO 27)
@@ -31,12 +51,16 @@
 
 #define servo 20               // Pino do servo motor
 #define buzzer 10              // Pino do buzzer
+#define sonda_irq 18           // Sem conexão: recebe bordas forçadas (INOVER) para medir o jitter da IRQ de GPIO
 
 static uint32_t last_time = 0; // Variável para armazenar o tempo da última interrupção
+#if TRACE_ENABLED
+static volatile uint32_t sonda_irq_us = 0; // Instante da última borda forçada em sonda_irq
+#endif
 PIO pio = pio0;                // Instância do PIO (Programmable I/O)
-uint sm = 0;                   // State machine do PIO
+ws2812_parallel_t matriz;      // Driver das matrizes de LEDs (todas as fitas em paralelo)
 ssd1306_t ssd;                 // Estrutura para o display SSD1306
-uint32_t led_buffer[NUM_PIXELS]; // Buffer para os LEDs da matriz
+uint32_t led_buffer[NUM_FITAS][NUM_PIXELS]; // Buffer para os LEDs de cada matriz
 uint16_t eixo_y = 0;           // Variável para armazenar o valor do eixo Y do joystick
 
 bool menu = false;             // Flag para indicar se o menu está ativo
@@ -44,7 +68,8 @@ int qtd_racao = 1000;          // Quantidade de ração disponível (em gramas)
 int qtd_agua = 1000;           // Quantidade de água disponível (em ml)
 int gramas_alimento = 50;      // Quantidade de ração a ser liberada por despejo (em gramas)
 int ml_agua = 30;              // Quantidade de água a ser liberada por despejo (em ml)
-const char *menu_options[] = {"Manual/Auto", "Racao/Agua", "Encher", "Voltar"}; // Opções do menu
+// Opções do menu, rasterizadas uma única vez
+ssd1306_label_t menu_options[] = {SSD1306_LABEL("Manual/Auto"), SSD1306_LABEL("Racao/Agua"), SSD1306_LABEL("Encher"), SSD1306_LABEL("Voltar")};
 int menu_index = 0;            // Índice da opção selecionada no menu
 int num_options = 4;           // Número de opções no menu
 bool medir_gramas = false;     // Flag para indicar que é necessário medir a ração
@@ -58,13 +83,50 @@ enum
     STATE_DONE   // Estado finalizado
 };
 int state = STATE_RACAO;       // Estado inicial: definir a quantidade de ração
+historico_t historico;         // Histórico de alimentações e alertas na flash
+barramento_t barramento;       // I2C compartilhado pelo display, RTC e sensores
+
+// Gráfico dos níveis de ração e água na tela inicial
+#define GRAFICO_PERIODO_MS 2000 // Intervalo entre amostras (uma coluna cada)
+grafico_t grafico;
+uint64_t proxima_amostra_us = 0;
+bool tela_inicial = false;          // O display mostra a tela inicial: basta avançar o gráfico
+bool enviando_tela_inicial = false; // O quadro em envio é o da tela inicial
+int racao_exibida = 0, agua_exibida = 0;
+
+volatile bool serial_pendente = false; // Bytes novos na serial durante a espera do ciclo
 
 bool modo_auto = false;        // Flag para indicar se o modo automático está ativo
 int tempo_auto_ms = 5000;      // Intervalo de tempo para o modo automático (em milissegundos)
 struct repeating_timer timer;  // Estrutura para o timer repetitivo
 
+// Textos fixos das telas redesenhadas a cada ciclo
+ssd1306_label_t txt_click = SSD1306_LABEL(".>click");
+ssd1306_label_t txt_racao = SSD1306_LABEL("A>racao");
+ssd1306_label_t txt_menu = SSD1306_LABEL("B>Menu");
+ssd1306_label_t txt_titulo_menu = SSD1306_LABEL("Menu:");
+ssd1306_label_t txt_seletor = SSD1306_LABEL(">");
+ssd1306_label_t txt_definir_racao = SSD1306_LABEL("Definir Racao:");
+ssd1306_label_t txt_definir_agua = SSD1306_LABEL("Definir Agua:");
+
+// Auto-repetição do joystick: zona morta, atraso (ms), taxa mínima, taxa
+// máxima, aceleração e limite (passos/s)
+const repeticao_curva_t curva_menu = {500, 400, 3, 3, 0, 3};          // 4 opções, sem aceleração
+const repeticao_curva_t curva_intervalo = {200, 300, 3, 12, 40, 40};  // 1..23 de ponta a ponta em ~1 s
+const repeticao_curva_t curva_digito = {500, 400, 4, 8, 0, 8};        // Troca do dígito selecionado
+const repeticao_curva_t curva_porcao = {500, 250, 4, 20, 1000, 1000}; // 0..500 em ~1 s pelas unidades
+repeticao_t rep_menu = REPETICAO_INIT(&curva_menu);
+repeticao_t rep_intervalo = REPETICAO_INIT(&curva_intervalo);
+repeticao_t rep_digito = REPETICAO_INIT(&curva_digito);
+repeticao_t rep_porcao = REPETICAO_INIT(&curva_porcao);
+
+#if PERFIL_INTEIRO
+const uint32_t period = 20000;    // Período do PWM (em microssegundos)
+const uint32_t pwm_hz = 1000000;  // Contagem do PWM (1 MHz: nível e período em µs), qualquer que seja o clk_sys
+#else
 const float period = 20000;    // Período do PWM (em microssegundos)
-const float divider_pwm = 125.0f; // Divisor de frequência do PWM
+const float pwm_hz = 1000000;  // Contagem do PWM (1 MHz: nível e período em µs), qualquer que seja o clk_sys
+#endif
 
 // Protótipos das funções
 void button_init(int pin);
@@ -75,44 +137,88 @@ void atualizar_barras();
 void display_init();
 void iniciar_adc();
 bool botao_joystick_pressionado();
+void marcar_joystick(uint canal, uint16_t valor);
 void atualizar_display_menu();
 void atualizar_menu_com_joystick();
 bool alimentar_automatico(struct repeating_timer *t);
 void setup_pwm(int pin);
+void definir_divisor_pwm(uint slice, uint32_t hz);
+int nivel_barra(int qtd);
 void update_number_display();
-void navigate_digits();
-void adjust_digit();
+bool navigate_digits();
+bool adjust_digit();
 void confirm_number();
 void despejar();
 void manual_automatico();
 void play_tone(int pin, uint32_t frequency, uint32_t duration_ms);
 void play_sound(int f1, int f2, int t1, int t2);
+void quadro_enviado(ssd1306_t *ssd, uint32_t inicio_us);
+void registrar_historico(historico_tipo_t tipo, uint8_t flags, int racao_real, int agua_real);
+bool config_definir(uint8_t campo, int32_t valor, bool aplicar);
+bool config_obter(uint8_t campo, int32_t *valor);
+void alimentar_remoto();
+void clock_antes();
+void clock_depois(uint32_t hz);
+void repouso_entrar();
+void repouso_sair();
+void amostrar_niveis();
+void atender_serial();
+void serial_chegou(void *param);
+void esperar_ciclo(uint32_t ms);
+void tarefas_nucleo1();
 
 int main()
 {
     stdio_init_all(); // Inicializa a comunicação serial (para debug)
+    dlog_init();      // Inicia a drenagem do log diferido no núcleo 1
     button_init(buttonA); // Inicializa o botão A
     button_init(buttonB); // Inicializa o botão B
     button_init(botao_joystick); // Inicializa o botão do joystick
     matrix_init(); // Inicializa a matriz de LEDs
     display_init(); // Inicializa o display OLED
+    grafico_init(&grafico, &ssd, 4, 120, 4, 2, 0, 1000, 2); // Dentro da moldura, entre os textos
+    historico_montar(&historico, historico_flash_padrao()); // Retoma o histórico gravado na flash
+    // Configuração e telemetria pelo protocolo binário da serial
+    static const protocolo_app_t app_protocolo = {config_definir, config_obter, alimentar_remoto};
+    protocolo_init(&app_protocolo);
+    dlog_tarefa(tarefas_nucleo1); // Telemetria, espelho do display e vigia do I2C no núcleo 1
     iniciar_adc(); // Inicializa o ADC (para o joystick)
     setup_pwm(servo); // Configura o PWM para o servo motor
 
+    // Troca de clock entre as rajadas de trabalho e a espera do loop
+    static const governador_app_t app_governador = {clock_antes, clock_depois};
+    governador_init(&app_governador);
+
+    // Painel e matriz apagados entre alimentações, com o núcleo em WFI
+    static const repouso_app_t app_repouso = {repouso_entrar, repouso_sair};
+    repouso_init(&app_repouso);
+
     // Configura o pino do buzzer como saída
     gpio_init(buzzer);
     gpio_set_dir(buzzer, GPIO_OUT);
 
     pwm_set_gpio_level(servo, 2400); // Define o nível do PWM (duty cycle) no pino do servo
 
-    // Configura interrupções para os botões A e B
-    gpio_set_irq_enabled_with_callback(buttonA, GPIO_IRQ_EDGE_FALL, true, &debounce);
-    gpio_set_irq_enabled_with_callback(buttonB, GPIO_IRQ_EDGE_FALL, true, &debounce);
+    // Configura interrupções para os botões A e B (a borda de subida só é gravada)
+    gpio_set_irq_enabled_with_callback(buttonA, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &debounce);
+    gpio_set_irq_enabled_with_callback(buttonB, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &debounce);
+#if TRACE_ENABLED
+    gpio_init(sonda_irq); // Bordas de teste do núcleo 1, atendidas pelo mesmo debounce
+    gpio_set_irq_enabled(sonda_irq, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+#endif
     sleep_ms(2000); // Aguarda 2 segundos para estabilização
     play_sound(523, 880, 100, 200); // Toca um som de inicialização
 
     while (true)
     {
+        // Sem uso há REPOUSO_APOS_MS: dorme até o timer, um botão ou a serial
+        if (!medir_gramas && !menu && repouso_ocioso())
+        {
+            repouso_dormir();
+        }
+        TRACE_BEGIN(TRACE_LOOP);
+        governador_definir(GOVERNADOR_RAJADA); // Desenho, LEDs e despejo no clock máximo
+        amostrar_niveis(); // Novas colunas do gráfico da tela inicial
         atualizar_barras(); // Atualiza as barras de ração e água no display
         atualizar_leds();   // Atualiza a matriz de LEDs
 
@@ -120,7 +226,7 @@ int main()
         if (menu)
         {
             atualizar_menu_com_joystick(); // Atualiza o menu com base no joystick
-            ssd1306_draw_string(&ssd, ".>click", 70, 48); // Exibe uma mensagem no display
+            ssd1306_draw_label(&ssd, &txt_click, 70, 48); // Exibe uma mensagem no display
             ssd1306_send_data(&ssd); // Envia os dados para o display
 
             // Verifica se o botão do joystick foi pressionado
@@ -135,26 +241,32 @@ int main()
 
                 case 1:
                     editing = true; // Entra no modo de edição
+                    repeticao_reiniciar(&rep_digito);
+                    repeticao_reiniciar(&rep_porcao);
+                    update_number_display(); // Exibe o número inicial
                     while (true)
                     {
-                        update_number_display(); // Atualiza o display com o número
-                        navigate_digits();       // Navega entre os dígitos
-                        adjust_digit();          // Ajusta o dígito atual
+                        bool mudou = navigate_digits(); // Navega entre os dígitos
+                        mudou |= adjust_digit();        // Ajusta o número no dígito atual
+                        if (mudou)
+                        {
+                            update_number_display(); // Redesenha só quando algo mudou
+                        }
                         confirm_number();        // Confirma e salva o número
                         if (state == STATE_DONE)
                         {
                             state = STATE_RACAO; // Reinicia o estado para a próxima vez
                             break;
                         }
-                        sleep_ms(50); // Aguarda 50ms
+                        sleep_ms(REPETICAO_PERIODO_MS); // Leitura rápida para a auto-repetição
                     }
                     break;
 
                 case 2:
-                    printf("Encher selecionado\n");
+                    DLOG0(DLOG_ENCHER);
                     qtd_racao = 1000; // Enche a ração
                     qtd_agua = 1000;  // Enche a água
-                    printf("Racao/agua cheios\n");
+                    DLOG0(DLOG_CHEIOS);
                     ssd1306_fill(&ssd, false); // Limpa o display
                     ssd1306_draw_string(&ssd, "Racao/agua", 5, 20); // Exibe mensagem
                     ssd1306_draw_string(&ssd, "cheios", 5, 30); // Exibe mensagem
@@ -163,7 +275,7 @@ int main()
                     break;
 
                 case 3:
-                    printf("Sair selecionado\n");
+                    DLOG0(DLOG_SAIR);
                     menu = false; // Sai do menu
                     ssd1306_fill(&ssd, false); // Limpa o display
                     ssd1306_send_data(&ssd); // Envia os dados para o display
@@ -172,23 +284,32 @@ int main()
                 }
             }
         }
-        else
+        else if (!tela_inicial || racao_exibida != qtd_racao || agua_exibida != qtd_agua)
         {
             bool borda = true;
             borda = !borda;
-            char racao[20];
-            char agua[20];
             // Atualiza o conteúdo do display com animações
             ssd1306_fill(&ssd, !borda);                       // Limpa o display
             ssd1306_rect(&ssd, 3, 3, 122, 58, borda, !borda); // Desenha um retângulo
-            sprintf(racao, "Racao: %d g", qtd_racao); // Formata a string da ração
-            sprintf(agua, "Agua: %d ml", qtd_agua);   // Formata a string da água
 
-            ssd1306_draw_string(&ssd, racao, 8, 10);     // Exibe a quantidade de ração
-            ssd1306_draw_string(&ssd, agua, 8, 20);      // Exibe a quantidade de água
-            ssd1306_draw_string(&ssd, "A>racao", 3, 48); // Exibe instrução para o botão A
-            ssd1306_draw_string(&ssd, "B>Menu", 75, 48); // Exibe instrução para o botão B
+            bitmap_desenhar(&ssd, BITMAP_TIGELA, 7, 10);     // Ração em gramas
+            bitmap_numero(&ssd, qtd_racao, 25, 10);
+            bitmap_desenhar(&ssd, BITMAP_GOTA, 66, 10);      // Água em ml
+            bitmap_numero(&ssd, qtd_agua, 84, 10);
+            grafico_desenhar(&grafico);                     // Histórico dos níveis (ração contínua, água pontilhada)
+            ssd1306_draw_label(&ssd, &txt_racao, 3, 48);    // Exibe instrução para o botão A
+            ssd1306_draw_label(&ssd, &txt_menu, 75, 48);    // Exibe instrução para o botão B
+            enviando_tela_inicial = true;
             ssd1306_send_data(&ssd); // Envia os dados para o display
+            enviando_tela_inicial = false;
+            racao_exibida = qtd_racao;
+            agua_exibida = qtd_agua;
+        }
+        else if (grafico.pendentes)
+        {
+            // Tela inicial sem mudanças nos textos: só o gráfico anda, numa janela
+            grafico_avancar(&grafico);
+            grafico_enviar(&grafico);
         }
 
         // Verifica se é necessário liberar ração
@@ -197,7 +318,10 @@ int main()
             despejar(); // Libera a ração e água
             medir_gramas = false; // Reseta a flag
         }
-        sleep_ms(300); // Aguarda 300ms antes de atualizar novamente
+
+        TRACE_END(TRACE_LOOP);
+        governador_definir(GOVERNADOR_OCIOSO); // Só espera até o próximo ciclo
+        esperar_ciclo(300); // Aguarda 300ms antes de atualizar, atendendo a serial
     }
 }
 
@@ -212,12 +336,28 @@ void button_init(int pin)
 // Função de debounce para os botões
 void debounce(uint gpio, uint32_t events)
 {
+#if TRACE_ENABLED
+    if (gpio == sonda_irq)
+    {
+        // Jitter: atraso entre a borda forçada pelo núcleo 1 e a entrada aqui
+        TRACE_COUNTER(TRACE_JITTER_GPIO_US, (int32_t)(time_us_32() - sonda_irq_us));
+        return;
+    }
+#endif
+    TRACE_BEGIN(TRACE_IRQ_GPIO);
+    entrada_borda(gpio, events); // Grava a borda para replay
     uint32_t current_time = to_us_since_boot(get_absolute_time()); // Obtém o tempo atual
 
     // Verifica se o tempo desde a última interrupção é maior que 200ms (debouncing)
-    if (current_time - last_time > 200000)
+    if ((events & GPIO_IRQ_EDGE_FALL) && current_time - last_time > 200000)
     {
         last_time = current_time; // Atualiza o tempo da última interrupção
+        if (repouso_acordar(REPOUSO_BOTAO))
+        {
+            TRACE_END(TRACE_IRQ_GPIO);
+            return; // O toque só acorda o painel
+        }
+        latencia_entrada(LATENCIA_BOTAO);
 
         if (gpio == buttonA && !modo_auto)
         {
@@ -229,64 +369,84 @@ void debounce(uint gpio, uint32_t events)
             menu = true; // Ativa o menu
         }
     }
+    TRACE_END(TRACE_IRQ_GPIO);
 }
 
 // Função para inicializar a matriz de LEDs
 void matrix_init()
 {
-    uint offset = pio_add_program(pio, &ws2812_program); // Adiciona o programa PIO para os LEDs
-    ws2812_program_init(pio, sm, offset, MATRIX_LED, 800000, false); // Inicializa a matriz de LEDs
-    pio_sm_set_enabled(pio, sm, true); // Habilita a state machine do PIO
+    // Uma única state machine e um canal de DMA atendem todas as fitas
+    ws2812_parallel_init(&matriz, pio, MATRIX_LED, NUM_FITAS, NUM_PIXELS, 800000);
     sleep_ms(100); // Aguarda 100ms para estabilização
 }
 
 // Função para atualizar os LEDs da matriz
 void atualizar_leds()
 {
-    for (int i = 0; i < NUM_PIXELS; i++)
+    TRACE_BEGIN(TRACE_LEDS);
+    const uint32_t *fitas[NUM_FITAS];
+    for (int i = 0; i < NUM_FITAS; i++)
     {
-        pio_sm_put_blocking(pio, sm, led_buffer[i]); // Envia os dados para cada LED
+        fitas[i] = led_buffer[i];
     }
+    ws2812_parallel_pack(&matriz, fitas); // Transpõe os buffers em planos de bits
+    ws2812_parallel_show(&matriz);        // Envia por DMA sem bloquear o loop
+    TRACE_END(TRACE_LEDS);
 }
 
 // Função para atualizar as barras de ração e água no display
 void atualizar_barras()
 {
+    TRACE_BEGIN(TRACE_BARRAS);
+    uint32_t *leds = led_buffer[ESTACAO_LOCAL];
+
     // Limpa o buffer de LEDs
     for (int i = 0; i < NUM_PIXELS; i++)
     {
-        led_buffer[i] = 0; // Desliga todos os LEDs
+        leds[i] = 0; // Desliga todos os LEDs
     }
 
     // Calcula o número de LEDs acesos para a ração
-    int leds_racao = (int)ceil((qtd_racao * 5.0) / 1000.0);
+    int leds_racao = nivel_barra(qtd_racao);
     int indices_racao[] = {4, 5, 14, 15, 24}; // Índices da coluna da ração
     for (int i = 0; i < leds_racao && i < 5; i++)
     {
-        led_buffer[indices_racao[i]] = 0x26000000; // Define a cor verde para os LEDs da ração
+        leds[indices_racao[i]] = 0x26000000; // Define a cor verde para os LEDs da ração
     }
 
     // Calcula o número de LEDs acesos para a água
-    int leds_agua = (int)ceil((qtd_agua * 5.0) / 1000.0);
+    int leds_agua = nivel_barra(qtd_agua);
     int indices_agua[] = {2, 7, 12, 17, 22}; // Índices da coluna da água
     for (int i = 0; i < leds_agua && i < 5; i++)
     {
-        led_buffer[indices_agua[i]] = 0x00002600; // Define a cor azul para os LEDs da água
+        leds[indices_agua[i]] = 0x00002600; // Define a cor azul para os LEDs da água
     }
+    TRACE_END(TRACE_BARRAS);
+}
+
+// LEDs acesos numa barra de 5 para 0..1000 (arredondado para cima)
+int nivel_barra(int qtd)
+{
+#if PERFIL_INTEIRO
+    return qtd <= 0 ? 0 : (qtd + 199) / 200; // Divisão por constante: vira multiplicação
+#else
+    return (int)ceil((qtd * 5.0) / 1000.0);
+#endif
 }
 
 // Função para inicializar o display OLED
 void display_init()
 {
     // Inicializa a comunicação I2C
-    i2c_init(I2C_PORT, 400 * 1000); // Configura o I2C a 400kHz
-    gpio_set_function(PIN_I2C_SDA, GPIO_FUNC_I2C); // Configura o pino SDA
-    gpio_set_function(PIN_I2C_SCL, GPIO_FUNC_I2C); // Configura o pino SCL
-    gpio_pull_up(PIN_I2C_SDA); // Habilita pull-up no pino SDA
-    gpio_pull_up(PIN_I2C_SCL); // Habilita pull-up no pino SCL
+    // Inicializa a comunicação I2C a 400kHz (pinos com pull-up, DMA e IRQ do gerenciador)
+    barramento_i2c_init(&barramento, I2C_PORT, PIN_I2C_SDA, PIN_I2C_SCL, 400 * 1000);
 
     // Inicializa o display SSD1306
     ssd1306_init(&ssd, WIDTH, HEIGHT, false, endereco, I2C_PORT);
+    ssd.ao_enviar = quadro_enviado; // Fecha as medições de latência a cada quadro
+    ssd.barramento = &barramento;   // Quadros em blocos, com espaço para os sensores entre eles
+    ssd.ao_atualizar = espelho_capturar; // Cópia para o espelho pela USB, quando ligado
+    espelho_init(&ssd);
     ssd1306_config(&ssd); // Configura o display
     ssd1306_send_data(&ssd); // Envia os dados para o display
 
@@ -309,32 +469,41 @@ bool botao_joystick_pressionado()
     static uint32_t last_time = 0;
     uint32_t current_time = to_us_since_boot(get_absolute_time());
 
-    if (!gpio_get(botao_joystick)) // Verifica se o botão foi pressionado
+    if (!entrada_gpio(botao_joystick)) // Verifica se o botão foi pressionado
     {
         if (current_time - last_time > 200000) // 200ms para debounce
         {
             last_time = current_time;
+            latencia_entrada(LATENCIA_BOTAO);
             return true;
         }
     }
     return false;
 }
 
+// Marca a latência quando um eixo do joystick cruza o limiar de ±500 para
+// fora; segurando, as leituras seguintes não são entradas novas
+void marcar_joystick(uint canal, uint16_t valor)
+{
+    static bool fora[2] = {false, false}; // Por canal do ADC
+    bool agora = valor < (2047 - 500) || valor > (2047 + 500);
+    if (agora && !fora[canal])
+    {
+        latencia_entrada(LATENCIA_JOYSTICK);
+    }
+    fora[canal] = agora;
+}
+
 // Função para atualizar o menu com base na posição do joystick
 void atualizar_menu_com_joystick()
 {
-    adc_select_input(0); // Seleciona o canal ADC correspondente ao eixo Y
-    uint16_t eixo_y = adc_read(); // Lê o valor do eixo Y
+    uint16_t eixo_y = entrada_adc(0); // Lê o valor do eixo Y (canal 0)
 
     // Navega no menu com base no valor do eixo Y
-    if (eixo_y < (2047 - 500))
-    {
-        menu_index = (menu_index + 1) % num_options; // Move para a próxima opção
-    }
-    else if (eixo_y > (2047 + 500))
-    {
-        menu_index = (menu_index - 1 + num_options) % num_options; // Move para a opção anterior
-    }
+    marcar_joystick(0, eixo_y);
+    // Para baixo desce na lista; segurando, repete
+    int passos = repeticao_passos(&rep_menu, eixo_y);
+    menu_index = ((menu_index - passos) % num_options + num_options) % num_options;
 
     atualizar_display_menu(); // Atualiza o display com o menu
 }
@@ -343,16 +512,16 @@ void atualizar_menu_com_joystick()
 void atualizar_display_menu()
 {
     ssd1306_fill(&ssd, false); // Limpa o display
-    ssd1306_draw_string(&ssd, "Menu:", 1, 1); // Exibe o título do menu
+    ssd1306_draw_label(&ssd, &txt_titulo_menu, 1, 1); // Exibe o título do menu
 
     // Exibe as opções do menu
     for (int i = 0; i < num_options; i++)
     {
         if (i == menu_index)
         {
-            ssd1306_draw_string(&ssd, ">", 1, 13 + i * 10); // Marca a opção selecionada
+            ssd1306_draw_label(&ssd, &txt_seletor, 1, 13 + i * 10); // Marca a opção selecionada
         }
-        ssd1306_draw_string(&ssd, menu_options[i], 10, 13 + i * 10); // Exibe a opção
+        ssd1306_draw_label(&ssd, &menu_options[i], 10, 13 + i * 10); // Exibe a opção
     }
 
     ssd1306_send_data(&ssd); // Envia os dados para o display
@@ -363,7 +532,7 @@ void manual_automatico()
 {
     char modo[20];
     modo_auto = !modo_auto; // Alterna o modo
-    printf("Modo alterado para: %s\n", modo_auto ? "AUTO" : "MANUAL");
+    DLOG0(modo_auto ? DLOG_MODO_AUTO : DLOG_MODO_MANUAL);
 
     if (!modo_auto)
     {
@@ -376,35 +545,39 @@ void manual_automatico()
 
     if (modo_auto)
     {
-        printf("Defina o tempo do modo automático...\n");
+        DLOG0(DLOG_DEFINIR_TEMPO);
+        repeticao_reiniciar(&rep_intervalo);
+        bool redesenhar = true;
 
         while (true)
         {
-            adc_select_input(1); // Seleciona o canal ADC correspondente ao eixo Y
-            uint16_t eixo_y = adc_read(); // Lê o valor do eixo Y
+            uint16_t eixo_y = entrada_adc(1); // Lê o valor do eixo Y (canal 1)
 
             // Ajusta o tempo do modo automático com base no joystick
-            if (eixo_y < (2047 - 200))
+            marcar_joystick(1, eixo_y);
+            int passos = repeticao_passos(&rep_intervalo, eixo_y);
+            if (passos)
             {
-                tempo_auto_ms -= 1000; // Diminui o tempo (mínimo de 1s)
+                tempo_auto_ms += passos * 1000; // Um passo por hora
                 if (tempo_auto_ms < 1000)
-                    tempo_auto_ms = 1000;
-            }
-            else if (eixo_y > (2047 + 200))
-            {
-                tempo_auto_ms += 1000; // Aumenta o tempo
+                    tempo_auto_ms = 1000; // Mínimo de 1 hora
                 if (tempo_auto_ms > 23000)
                     tempo_auto_ms = 23000; // Máximo 23 horas
+                redesenhar = true;
             }
 
             // Atualiza o display com o tempo
-            ssd1306_fill(&ssd, false);
-            char buffer[20];
-            sprintf(buffer, "Tempo: %d h", tempo_auto_ms / 1000);
-            ssd1306_draw_string(&ssd, buffer, 10, 20);
-            ssd1306_send_data(&ssd);
+            if (redesenhar)
+            {
+                ssd1306_fill(&ssd, false);
+                bitmap_desenhar(&ssd, BITMAP_RELOGIO, 10, 20);
+                uint8_t largura = bitmap_numero(&ssd, tempo_auto_ms / 1000, 30, 20);
+                ssd1306_draw_char(&ssd, 'h', 32 + largura, 26); // Alinhado à base dos dígitos
+                ssd1306_send_data(&ssd);
+                redesenhar = false;
+            }
 
-            sleep_ms(300);
+            sleep_ms(REPETICAO_PERIODO_MS);
 
             // Se pressionar o botão do joystick, salva e sai
             if (botao_joystick_pressionado())
@@ -439,11 +612,21 @@ void setup_pwm(int pin)
     gpio_set_function(pin, GPIO_FUNC_PWM); // Configura o pino como saída PWM
     uint slice = pwm_gpio_to_slice_num(pin); // Obtém o slice do PWM
     pwm_set_wrap(slice, period); // Define o período do PWM
-    pwm_set_clkdiv(slice, divider_pwm); // Define o divisor de frequência
+    definir_divisor_pwm(slice, clock_get_hz(clk_sys)); // Define o divisor de frequência
     pwm_set_gpio_level(servo, 0); // Define o nível inicial do PWM
     pwm_set_enabled(slice, true); // Habilita o PWM
 }
 
+// Divisor do PWM para contar a pwm_hz com o clk_sys em hz
+void definir_divisor_pwm(uint slice, uint32_t hz)
+{
+#if PERFIL_INTEIRO
+    pwm_set_clkdiv_int_frac(slice, hz / pwm_hz, hz % pwm_hz * 16 / pwm_hz); // Divisor 8.4 sem float
+#else
+    pwm_set_clkdiv(slice, hz / pwm_hz);
+#endif
+}
+
 // Função para atualizar o display com o número
 void update_number_display()
 {
@@ -453,59 +636,62 @@ void update_number_display()
     {
         if (state == STATE_RACAO)
         {
-            ssd1306_draw_string(&ssd, "Definir Racao:", 5, 5); // Exibe "Definir Racao:"
+            ssd1306_draw_label(&ssd, &txt_definir_racao, 5, 5); // Exibe "Definir Racao:"
         }
         else if (state == STATE_AGUA)
         {
-            ssd1306_draw_string(&ssd, "Definir Agua:", 5, 5); // Exibe "Definir Agua:"
+            ssd1306_draw_label(&ssd, &txt_definir_agua, 5, 5); // Exibe "Definir Agua:"
         }
 
         // Exibe os dígitos do número
         char number_str[4];
         sprintf(number_str, "%d%d%d", number_digits[0], number_digits[1], number_digits[2]);
-        ssd1306_draw_string(&ssd, number_str, 5, 20);
+        ssd1306_draw_string_cached(&ssd, number_str, 5, 20);
 
         // Exibe um indicador para o dígito atual
-        char indicator[4] = "    ";
+        char indicator[5] = "    ";
         indicator[digit_index] = '^';
-        ssd1306_draw_string(&ssd, indicator, 5, 30);
+        ssd1306_draw_string_cached(&ssd, indicator, 5, 30);
 
         ssd1306_send_data(&ssd); // Envia os dados para o display
     }
 }
 
-// Função para navegar entre os dígitos
-void navigate_digits()
+// Função para navegar entre os dígitos; retorna true se o dígito selecionado mudou
+bool navigate_digits()
 {
-    adc_select_input(1); // Seleciona o canal ADC correspondente ao eixo X
-    uint16_t eixo_x = adc_read(); // Lê o valor do eixo X
+    uint16_t eixo_x = entrada_adc(1); // Lê o valor do eixo X (canal 1)
+    marcar_joystick(1, eixo_x);
 
-    if (eixo_x < (2047 - 500)) // Joystick inclinado para a esquerda
-    {
-        digit_index = (digit_index - 1 + 3) % 3; // Move para o dígito anterior
-    }
-    else if (eixo_x > (2047 + 500)) // Joystick inclinado para a direita
-    {
-        digit_index = (digit_index + 1) % 3; // Move para o próximo dígito
-    }
-    sleep_ms(100); // Aguarda 75ms
+    // Esquerda/direita troca o dígito, com repetição lenta ao segurar
+    int passos = repeticao_passos(&rep_digito, eixo_x);
+    digit_index = ((digit_index + passos) % 3 + 3) % 3;
+    return passos != 0;
 }
 
-// Função para ajustar o dígito atual
-void adjust_digit()
+// Função para ajustar o número no dígito atual; retorna true se o número mudou
+bool adjust_digit()
 {
-    adc_select_input(0); // Seleciona o canal ADC correspondente ao eixo Y
-    uint16_t eixo_y = adc_read(); // Lê o valor do eixo Y
-    int index_final = digit_index == 0 ? 6 : 10; // Define o limite do dígito
-    if (eixo_y < (2047 - 500)) // Joystick inclinado para cima
-    {
-        number_digits[digit_index] = (number_digits[digit_index] - 1 + index_final) % index_final; // Aumenta o dígito
-    }
-    else if (eixo_y > (2047 + 500)) // Joystick inclinado para baixo
+    static const int peso[3] = {100, 10, 1}; // Valor de um passo em cada dígito
+    uint16_t eixo_y = entrada_adc(0); // Lê o valor do eixo Y (canal 0)
+    marcar_joystick(0, eixo_y);
+
+    // Segurando, a taxa acelera e o número corre com vai-um entre os dígitos
+    int passos = repeticao_passos(&rep_porcao, eixo_y);
+    if (!passos)
     {
-        number_digits[digit_index] = (number_digits[digit_index] + 1) % index_final; // Diminui o dígito
+        return false;
     }
-    sleep_ms(150); // Aguarda 75ms
+    int numero = number_digits[0] * 100 + number_digits[1] * 10 + number_digits[2];
+    numero += passos * peso[digit_index];
+    if (numero < 0)
+        numero = 0;
+    if (numero > 500)
+        numero = 500; // Máximo aceito por confirm_number()
+    number_digits[0] = numero / 100;
+    number_digits[1] = numero / 10 % 10;
+    number_digits[2] = numero % 10;
+    return true;
 }
 
 // Função para confirmar o número
@@ -579,6 +765,7 @@ void confirm_number()
 // Função para liberar ração e água
 void despejar()
 {
+    TRACE_BEGIN(TRACE_DESPEJAR);
     if (qtd_racao - gramas_alimento > 0 && qtd_agua - ml_agua > 0)
     {
         char agua[20];
@@ -602,7 +789,7 @@ void despejar()
         while (qtd_racao >= aux_qtd_racao - gramas_alimento && aux_qtd_racao - gramas_alimento >= 0)
         {
             qtd_racao -= rand() % 6; // Reduz a quantidade de ração
-            printf("racao: %d\n", qtd_racao);
+            DLOG1(DLOG_RACAO, qtd_racao);
             sleep_ms(100);
         }
 
@@ -613,51 +800,76 @@ void despejar()
         while (qtd_agua >= aux_qtd_agua - ml_agua && aux_qtd_agua - ml_agua >= 0)
         {
             qtd_agua -= rand() % 10; // Reduz a quantidade de água
-            printf("agua: %d\n", qtd_agua);
+            DLOG1(DLOG_AGUA, qtd_agua);
             sleep_ms(100);
         }
 
         pwm_set_gpio_level(servo, 2400); // Retorna o servo à posição inicial
         sleep_ms(100);
+
+        // Registra o pedido e o que de fato foi dispensado
+        registrar_historico(HISTORICO_ALIMENTACAO, 0, aux_qtd_racao - qtd_racao, aux_qtd_agua - qtd_agua);
     }
     else
     {
+        // Registra o alerta com o estoque disponível
+        registrar_historico(HISTORICO_ALERTA,
+                            (qtd_racao - gramas_alimento < 0 ? HISTORICO_FALTA_RACAO : 0) |
+                                (qtd_agua - ml_agua < 0 ? HISTORICO_FALTA_AGUA : 0),
+                            qtd_racao, qtd_agua);
+
         if (qtd_racao - gramas_alimento < 0)
         {
             ssd1306_fill(&ssd, false);
+            bitmap_desenhar(&ssd, BITMAP_ALERTA, 56, 2);
             ssd1306_draw_string(&ssd, "Racao", 5, 20);
             ssd1306_draw_string(&ssd, "Insuficiente", 5, 30);
             ssd1306_send_data(&ssd);
-            printf("Racao insuficiente");
+            DLOG0(DLOG_RACAO_INSUFICIENTE);
         }
         if (qtd_agua - ml_agua < 0)
         {
             ssd1306_fill(&ssd, false);
+            bitmap_desenhar(&ssd, BITMAP_ALERTA, 56, 2);
             ssd1306_draw_string(&ssd, "Agua", 5, 20);
             ssd1306_draw_string(&ssd, "Insuficiente", 5, 30);
             ssd1306_send_data(&ssd);
-            printf("Agua insuficiente");
+            DLOG0(DLOG_AGUA_INSUFICIENTE);
         }
         play_sound(262, 262, 150, 200); // Toca um som de alerta
         sleep_ms(3000);
     }
+    TRACE_END(TRACE_DESPEJAR);
 }
 
 // Função para alimentar automaticamente
 bool alimentar_automatico(struct repeating_timer *t)
 {
+    TRACE_BEGIN(TRACE_IRQ_TIMER);
+#if TRACE_ENABLED
+    // Jitter: atraso do disparo em relação ao período programado
+    static uint32_t ultimo_disparo = 0;
+    uint32_t agora = time_us_32();
+    if (ultimo_disparo)
+    {
+        TRACE_COUNTER(TRACE_JITTER_TIMER_US, (int32_t)(agora - ultimo_disparo) - tempo_auto_ms * 1000);
+    }
+    ultimo_disparo = agora;
+#endif
     medir_gramas = true; // Ativa a liberação de ração
+    repouso_acordar(REPOUSO_TIMER);
+    TRACE_END(TRACE_IRQ_TIMER);
     return true;
 }
 
 // Função para gerar um tom
 void play_tone(int pin, uint32_t frequency, uint32_t duration_ms)
 {
-    uint32_t period_us = 1000000 / frequency; // Período em microssegundos
-    uint32_t half_period_us = period_us / 2;  // Metade do período
+    uint32_t half_period_us = 500000 / frequency; // Metade do período (uma divisão por tom, fora do laço)
+    uint32_t duration_us = duration_ms * 1000;
 
     uint32_t start_time = to_us_since_boot(get_absolute_time()); // Tempo inicial
-    while (to_us_since_boot(get_absolute_time()) - start_time < duration_ms * 1000)
+    while (to_us_since_boot(get_absolute_time()) - start_time < duration_us)
     {
         gpio_put(pin, 1);         // Liga o buzzer
         sleep_us(half_period_us); // Espera metade do período
@@ -677,4 +889,270 @@ void play_sound(int f1, int f2, int t1, int t2)
         play_tone(buzzer, frequencies[i], durations[i]); // Toca cada tom
         sleep_ms(50);                                    // Pequena pausa entre os tons
     }
-}
\ No newline at end of file
+}
+// Chamada pelo driver do display ao fim de cada quadro enviado
+void quadro_enviado(ssd1306_t *ssd, uint32_t inicio_us)
+{
+    (void)ssd;
+    latencia_quadro(inicio_us); // Primeiro quadro após uma entrada fecha a medição
+    repouso_quadro(inicio_us);  // E o primeiro após um despertar
+    tela_inicial = enviando_tela_inicial; // Qualquer outra tela invalida o gráfico no display
+}
+
+// Grava um evento de alimentação no histórico da flash
+void registrar_historico(historico_tipo_t tipo, uint8_t flags, int racao_real, int agua_real)
+{
+    historico_evento_t ev = {
+        .tipo = tipo,
+        .estacao = ESTACAO_LOCAL,
+        .flags = flags | (modo_auto ? HISTORICO_AUTOMATICO : 0),
+        .racao_pedida = gramas_alimento,
+        .racao_real = racao_real < 0 ? 0 : racao_real,
+        .agua_pedida = ml_agua,
+        .agua_real = agua_real < 0 ? 0 : agua_real,
+    };
+    historico_registrar(&historico, &ev);
+}
+
+// Valida (aplicar = false) ou aplica um campo recebido pelo protocolo binário
+bool config_definir(uint8_t campo, int32_t valor, bool aplicar)
+{
+    switch (campo)
+    {
+    case CAMPO_RACAO_PORCAO:
+        if (valor < 1 || valor > 500)
+            return false; // Mesmos limites do editor de dígitos
+        if (aplicar)
+            gramas_alimento = valor;
+        return true;
+
+    case CAMPO_AGUA_PORCAO:
+        if (valor < 1 || valor > 500)
+            return false;
+        if (aplicar)
+            ml_agua = valor;
+        return true;
+
+    case CAMPO_ESTOQUE_RACAO:
+        if (valor < 0 || valor > 1000)
+            return false;
+        if (aplicar)
+            qtd_racao = valor;
+        return true;
+
+    case CAMPO_ESTOQUE_AGUA:
+        if (valor < 0 || valor > 1000)
+            return false;
+        if (aplicar)
+            qtd_agua = valor;
+        return true;
+
+    case CAMPO_INTERVALO_H:
+        if (valor < 1 || valor > 23)
+            return false; // Mesmos limites do ajuste pelo joystick
+        if (aplicar)
+        {
+            tempo_auto_ms = valor * 1000;
+            if (modo_auto)
+            {
+                // Reprograma o temporizador com o novo intervalo
+                cancel_repeating_timer(&timer);
+                add_repeating_timer_ms(tempo_auto_ms, alimentar_automatico, NULL, &timer);
+            }
+        }
+        return true;
+
+    case CAMPO_MODO_AUTO:
+        if (valor != 0 && valor != 1)
+            return false;
+        if (aplicar && modo_auto != valor)
+        {
+            modo_auto = valor;
+            DLOG0(modo_auto ? DLOG_MODO_AUTO : DLOG_MODO_MANUAL);
+            cancel_repeating_timer(&timer);
+            if (modo_auto)
+                add_repeating_timer_ms(tempo_auto_ms, alimentar_automatico, NULL, &timer);
+        }
+        return true;
+    }
+    return false;
+}
+
+// Estado exportado nas leituras e na telemetria (também chamada pelo núcleo 1)
+bool config_obter(uint8_t campo, int32_t *valor)
+{
+    switch (campo)
+    {
+    case CAMPO_RACAO_PORCAO: *valor = gramas_alimento; return true;
+    case CAMPO_AGUA_PORCAO: *valor = ml_agua; return true;
+    case CAMPO_INTERVALO_H: *valor = tempo_auto_ms / 1000; return true;
+    case CAMPO_MODO_AUTO: *valor = modo_auto; return true;
+    case CAMPO_ESTOQUE_RACAO: *valor = qtd_racao; return true;
+    case CAMPO_ESTOQUE_AGUA: *valor = qtd_agua; return true;
+    case CAMPO_TEMPO_MS: *valor = to_ms_since_boot(get_absolute_time()); return true;
+    }
+    return false;
+}
+
+// Despejo pedido pelo protocolo: segue o mesmo caminho do botão A
+void alimentar_remoto()
+{
+    medir_gramas = true;
+}
+
+// Antes de uma troca de clock: a matriz termina o quadro em andamento
+void clock_antes()
+{
+    ws2812_parallel_wait(&matriz);
+    barramento_pausar(&barramento); // Nenhum bloco I2C atravessa a troca
+}
+
+// Depois da troca: recalcula os divisores derivados de clk_sys/clk_peri
+void clock_depois(uint32_t hz)
+{
+    ws2812_parallel_retemporizar(&matriz); // Bits do WS2812 a 800 kHz
+    definir_divisor_pwm(pwm_gpio_to_slice_num(servo), hz); // Período do servo em 20 ms
+    i2c_set_baudrate(I2C_PORT, 400 * 1000); // I2C do display a 400kHz
+    barramento_retomar(&barramento);
+}
+
+// Antes de dormir: apaga o painel e a matriz e deixa o botão do joystick acordar
+void repouso_entrar()
+{
+    ssd1306_command(&ssd, SET_DISP | 0x00); // Display desligado (a RAM é mantida)
+    barramento_pausar(&barramento);         // O I2C e o DMA ficam sem clock
+    for (int i = 0; i < NUM_FITAS; i++)
+    {
+        for (int j = 0; j < NUM_PIXELS; j++)
+        {
+            led_buffer[i][j] = 0;
+        }
+    }
+    atualizar_leds();
+    ws2812_parallel_wait(&matriz); // O PIO fica sem clock durante o repouso
+    gpio_set_irq_enabled(botao_joystick, GPIO_IRQ_EDGE_FALL, true);
+}
+
+// Ao acordar: religa o painel; o próximo ciclo do loop redesenha a tela e a matriz
+void repouso_sair()
+{
+    gpio_set_irq_enabled(botao_joystick, GPIO_IRQ_EDGE_FALL, false);
+    barramento_retomar(&barramento);
+    ssd1306_command(&ssd, SET_DISP | 0x01); // Display ligado
+    tela_inicial = false; // O primeiro quadro após o despertar é completo
+}
+
+// Uma amostra dos níveis a cada GRAFICO_PERIODO_MS; após um repouso longo,
+// repete o último nível nas colunas que faltaram
+void amostrar_niveis()
+{
+    uint64_t agora = time_us_64();
+    int16_t niveis[2] = {qtd_racao, qtd_agua};
+    for (int i = 0; agora >= proxima_amostra_us && i < grafico.largura; i++)
+    {
+        grafico_adicionar(&grafico, niveis);
+        proxima_amostra_us += GRAFICO_PERIODO_MS * 1000;
+    }
+    if (agora >= proxima_amostra_us)
+    {
+        proxima_amostra_us = agora + GRAFICO_PERIODO_MS * 1000;
+    }
+}
+
+// Quadros do protocolo binário e comandos de diagnóstico pela serial, até
+// esvaziar a entrada (o aviso de bytes disponíveis só vem com bytes novos).
+// Cada troca de clock para o núcleo 1 e recalcula os divisores (inclusive o
+// da UART), então o clock sobe uma vez, no primeiro comando reconhecido, e
+// volta uma vez no fim.
+void atender_serial()
+{
+    static const char comandos[] = "TLRHGPIAE";
+    bool rajada = false;
+    int c;
+    while ((c = protocolo_receber()) != PICO_ERROR_TIMEOUT)
+    {
+        if (!memchr(comandos, c, sizeof(comandos) - 1))
+        {
+            continue; // \r, \n e outros bytes fora de um quadro
+        }
+        if (!rajada)
+        {
+            governador_definir(GOVERNADOR_RAJADA); // Exportações no clock máximo
+            rajada = true;
+        }
+        switch (c)
+        {
+        case 'T':
+            trace_exportar(); // Exporta o trace (só com TRACE_ENABLED)
+            break;
+        case 'L':
+            latencia_relatorio(); // Histograma de latência entrada -> painel
+            break;
+        case 'R':
+            entrada_exportar(); // Gravação das entradas para replay no host
+            break;
+        case 'H':
+            historico_exportar(&historico); // Histórico de alimentações da flash
+            break;
+        case 'G':
+            governador_relatorio(); // Tempo em cada clock e custo das transições
+            break;
+        case 'P':
+            repouso_relatorio(); // Tempo dormindo, despertares e corrente estimada
+            break;
+        case 'I':
+            barramento_relatorio(&barramento); // Espera por prioridade, falhas e recuperações do I2C
+            break;
+        case 'A':
+            bitmap_relatorio(); // Flash dos ícones e dígitos e tempo de desenho
+            break;
+        case 'E':
+            espelho_relatorio(); // Quadros e bytes do espelho do display e custo da captura
+            break;
+        }
+    }
+    if (rajada)
+    {
+        governador_definir(GOVERNADOR_OCIOSO);
+    }
+}
+
+void serial_chegou(void *param)
+{
+    (void)param;
+    serial_pendente = true;
+    __sev(); // Acorda o WFE de esperar_ciclo
+}
+
+// Espera até o próximo ciclo do loop sem segurar a serial: um pedido do
+// protocolo é atendido quando chega, e não só uma vez a cada ciclo
+void esperar_ciclo(uint32_t ms)
+{
+    absolute_time_t fim = make_timeout_time_ms(ms);
+    stdio_set_chars_available_callback(serial_chegou, NULL);
+    do
+    {
+        serial_pendente = false; // Antes de ler: um byte que chegar durante a leitura acorda de novo
+        atender_serial();
+        while (!serial_pendente && !time_reached(fim))
+            best_effort_wfe_or_timeout(fim);
+    } while (!time_reached(fim));
+    stdio_set_chars_available_callback(NULL, NULL);
+}
+
+// Tarefas periódicas do núcleo 1 (a cada DLOG_PERIODO_MS)
+void tarefas_nucleo1()
+{
+    protocolo_telemetria();
+    espelho_tarefa(); // Diferenças do display para o visualizador, dentro do orçamento
+    barramento_vigiar(&barramento); // Recupera o I2C se um bloco travou sem ninguém esperando
+#if TRACE_ENABLED
+    // Uma borda de teste por ciclo: o pino não distingue a borda forçada de
+    // uma real, e a interrupção no núcleo 0 sofre os mesmos atrasos
+    static bool sonda_alta = false;
+    sonda_alta = !sonda_alta;
+    sonda_irq_us = time_us_32();
+    __dmb();
+    gpio_set_inover(sonda_irq, sonda_alta ? GPIO_OVERRIDE_HIGH : GPIO_OVERRIDE_LOW);
+#endif
+}
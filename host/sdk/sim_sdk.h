@@ -0,0 +1,137 @@
+#ifndef SIM_SDK_H
+#define SIM_SDK_H
+
+// Substitutos do pico-sdk para o simulador do host. Só o que o firmware
+// usa é declarado; a implementação (sim_sdk.c) roda sobre um relógio
+// virtual e repassa entradas, I2C e temporizadores para o simulador.
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+typedef struct pio_hw { volatile uint32_t txf[4]; } pio_hw_t;
+typedef pio_hw_t *PIO;
+extern pio_hw_t sim_pio0, sim_pio1;
+#define pio0 (&sim_pio0)
+#define pio1 (&sim_pio1)
+typedef struct { uint32_t clkdiv; } pio_sm_config;
+typedef struct pio_program { const uint16_t *instructions; uint8_t length; int8_t origin; } pio_program_t;
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t sim_i2c0, sim_i2c1;
+#define i2c0 (&sim_i2c0)
+#define i2c1 (&sim_i2c1)
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *rt);
+struct repeating_timer { int64_t delay_us; repeating_timer_callback_t callback; void *user_data; uint64_t proximo; bool ativo; struct repeating_timer *prox; };
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+typedef struct { uint32_t salvo; } critical_section_t; // Um só núcleo: basta mascarar as interrupções
+enum { GPIO_IN = 0, GPIO_OUT = 1 };
+enum gpio_function { GPIO_FUNC_SPI = 1, GPIO_FUNC_UART = 2, GPIO_FUNC_I2C = 3, GPIO_FUNC_PWM = 4, GPIO_FUNC_SIO = 5, GPIO_FUNC_PIO0 = 6, GPIO_FUNC_NULL = 0x1f };
+enum { GPIO_IRQ_LEVEL_LOW = 1, GPIO_IRQ_LEVEL_HIGH = 2, GPIO_IRQ_EDGE_FALL = 4, GPIO_IRQ_EDGE_RISE = 8 };
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+typedef struct { uint32_t ctrl; } dma_channel_config;
+enum clock_index { clk_gpout0, clk_gpout1, clk_gpout2, clk_gpout3, clk_ref, clk_sys, clk_peri, clk_usb, clk_adc, clk_rtc };
+typedef struct { volatile uint32_t sleep_en0, sleep_en1; } clocks_hw_t;
+extern clocks_hw_t sim_clocks_hw;
+#define clocks_hw (&sim_clocks_hw)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_SPI1_BITS (1u << 30)
+#define CLOCKS_SLEEP_EN0_CLK_PERI_SPI1_BITS (1u << 29)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_SPI0_BITS (1u << 28)
+#define CLOCKS_SLEEP_EN0_CLK_PERI_SPI0_BITS (1u << 27)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_PIO1_BITS (1u << 15)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_PIO0_BITS (1u << 14)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_I2C1_BITS (1u << 11)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_I2C0_BITS (1u << 10)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_DMA_BITS (1u << 6)
+#define CLOCKS_SLEEP_EN0_CLK_SYS_ADC_BITS (1u << 2)
+#define CLOCKS_SLEEP_EN0_CLK_ADC_ADC_BITS (1u << 1)
+#define CLOCKS_SLEEP_EN1_CLK_SYS_UART1_BITS (1u << 25)
+#define CLOCKS_SLEEP_EN1_CLK_PERI_UART1_BITS (1u << 24)
+typedef struct { volatile uint32_t scr; } armv6m_scb_hw_t;
+extern armv6m_scb_hw_t sim_scb_hw;
+#define scb_hw (&sim_scb_hw)
+#define M0PLUS_SCR_SLEEPDEEP_BITS 0x4u
+#define PICO_ERROR_TIMEOUT (-1)
+#define PICO_OK 0
+
+uint64_t to_us_since_boot(absolute_time_t t);
+uint32_t to_ms_since_boot(absolute_time_t t);
+absolute_time_t get_absolute_time(void);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+absolute_time_t make_timeout_time_us(uint64_t us);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+bool time_reached(absolute_time_t t);
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+void busy_wait_us_32(uint32_t us);
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+void stdio_flush(void);
+int putchar_raw(int c);
+int stdio_put_string(const char *s, int len, bool newline, bool cr_translation);
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out);
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out);
+bool cancel_repeating_timer(repeating_timer_t *timer);
+uint get_core_num(void);
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+void tight_loop_contents(void);
+void __wfi(void);
+void __wfe(void);
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp);
+void critical_section_init(critical_section_t *cs);
+void critical_section_enter_blocking(critical_section_t *cs);
+void critical_section_exit(critical_section_t *cs);
+void __sev(void);
+void __dmb(void);
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_pull_up(uint gpio);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback);
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled);
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint16_t adc_read(void);
+uint pwm_gpio_to_slice_num(uint gpio);
+void pwm_set_wrap(uint slice, uint16_t wrap);
+void pwm_set_clkdiv(uint slice, float div);
+void pwm_set_clkdiv_int_frac(uint slice, uint8_t integer, uint8_t fract);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+void pwm_set_enabled(uint slice, bool enabled);
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+uint pio_add_program(PIO pio, const pio_program_t *program);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t div_int, uint8_t div_frac);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+uint32_t clock_get_hz(enum clock_index clk_index);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+void multicore_launch_core1(void (*entry)(void));
+bool multicore_lockout_start_timeout_us(uint64_t timeout_us);
+bool multicore_lockout_end_timeout_us(uint64_t timeout_us);
+bool flash_safe_execute_core_init(void);
+#endif
@@ -0,0 +1,12 @@
+// Substituto do cabeçalho gerado por pico_generate_pio_header
+#pragma once
+#include "sim_sdk.h"
+extern const pio_program_t ws2812_program, ws2812_parallel_program;
+#define ws2812_T1 3
+#define ws2812_T2 3
+#define ws2812_T3 4
+#define ws2812_parallel_T1 3
+#define ws2812_parallel_T2 3
+#define ws2812_parallel_T3 4
+static inline void ws2812_program_init(PIO pio, uint sm, uint offset, uint pin, float freq, bool rgbw) { (void)pio; (void)sm; (void)offset; (void)pin; (void)freq; (void)rgbw; }
+static inline void ws2812_parallel_program_init(PIO pio, uint sm, uint offset, uint pin_base, uint pin_count, uint32_t div) { (void)pio; (void)sm; (void)offset; (void)pin_base; (void)pin_count; (void)div; }
@@ -0,0 +1,58 @@
+#ifndef SIM_H
+#define SIM_H
+
+// Interface do simulador do host: relógio virtual, injeção de entradas
+// e observação do display. O firmware roda sem alterações por cima dos
+// substitutos do pico-sdk em sdk/.
+
+#include "sim_sdk.h"
+
+#define SIM_LARGURA 128
+#define SIM_PAGINAS 8
+#define SIM_MAX_EVENTOS 4096
+
+typedef enum {
+  SIM_EV_GPIO, // Nível de um pino de entrada (botões)
+  SIM_EV_ADC,  // Valor de um canal do ADC (joystick)
+  SIM_EV_SERIAL, // Byte recebido pela serial (valor)
+  SIM_EV_FIM   // Encerra a simulação
+} sim_evento_tipo_t;
+
+typedef struct {
+  uint64_t tempo_us;
+  uint8_t tipo;
+  uint8_t canal; // GPIO ou canal do ADC
+  uint16_t valor;
+} sim_evento_t;
+
+// Relógio virtual (µs desde o boot)
+uint64_t sim_agora_us();
+// Agenda um evento (a fila é mantida em ordem de tempo)
+void sim_agendar(uint64_t tempo_us, sim_evento_tipo_t tipo, uint8_t canal, uint16_t valor);
+// Dados disponíveis para getchar_timeout_us()
+void sim_serial_entrada(const uint8_t *dados, size_t n);
+
+// Estado do display simulado (páginas de 8 linhas, coluna a coluna)
+const uint8_t *sim_display();
+bool sim_display_ligado();
+
+// I2C: tempo de uma transferência e entrega ao display simulado
+uint64_t sim_i2c_duracao_us(i2c_inst_t *i2c, size_t len);
+void sim_i2c_aplicar(const uint8_t *src, size_t len);
+
+// Barramento I2C com o mock da porta do gerenciador (sim_barramento.c)
+void sim_barramento_sensores(uint32_t periodo_ms);
+void sim_barramento_travar_em(uint64_t tempo_us);
+bool sim_barramento_verificar();
+
+// Flash do histórico em RAM (sim_flash.c)
+bool sim_flash_carregar(const char *caminho);
+bool sim_flash_salvar(const char *caminho);
+void sim_flash_falhar_na_escrita(uint32_t n);
+
+// Ganchos definidos pelo executável do simulador
+extern void (*sim_ao_evento)(const sim_evento_t *ev);  // Antes de aplicar cada evento
+extern void (*sim_ao_quadro)(const uint8_t *display);  // Ao fim de cada escrita de dados no display
+extern void (*sim_ao_fim)();                           // No evento SIM_EV_FIM, antes de sair
+
+#endif
@@ -0,0 +1,205 @@
+#include "sim.h"
+#include "inc/barramento.h"
+#include <string.h>
+
+// Mock da porta do gerenciador do barramento (inc/barramento_i2c.c no
+// alvo). Cada bloco termina num temporizador virtual depois do tempo que
+// levaria no I2C; o display recebe os dados pelo mesmo modelo do
+// i2c_write_blocking. Há três escravos simulados, um RTC (DS3231) e um
+// sensor de nível na prioridade alta e um sensor de temperatura na normal,
+// e um travamento que só sai com a recuperação.
+
+#define SIM_DISPLAY 0x3C
+#define SIM_RTC 0x68
+#define SIM_NIVEL 0x44
+#define SIM_TEMPERATURA 0x48
+
+typedef struct {
+  i2c_inst_t *i2c;
+  repeating_timer_t fim;
+  bool ocupado;
+  bool travado;  // SDA preso: o bloco em andamento nunca termina
+  barramento_bloco_t bloco;
+} porta_sim_t;
+
+static porta_sim_t porta;
+static barramento_t *barramento = NULL;
+static uint32_t travamentos = 0, sensores_periodo_ms = UINT32_MAX;
+
+static uint8_t bcd(uint32_t v) { return (uint8_t)((v / 10) << 4 | v % 10); }
+
+// Registradores dos escravos a partir do endereço escrito no bloco
+static void ler_escravo(const barramento_bloco_t *bloco)
+{
+  uint8_t reg = bloco->n ? bloco->dados[bloco->n - 1] : 0;
+  uint32_t s = (uint32_t)(sim_agora_us() / 1000000);
+  uint8_t rtc[7] = {bcd(s % 60), bcd(s / 60 % 60), bcd(s / 3600 % 24), 1, 1, 1, 0x26};
+  for (uint i = 0; i < bloco->n_leitura; i++)
+  {
+    uint r = reg + i;
+    bloco->leitura[i] = bloco->endereco == SIM_RTC ? (r < sizeof(rtc) ? rtc[r] : 0) : (uint8_t)(0x5A + r);
+  }
+}
+
+static bool concluir(repeating_timer_t *t)
+{
+  (void)t;
+  porta.ocupado = false;
+  const barramento_bloco_t *bloco = &porta.bloco;
+  barramento_status_t status = BARRAMENTO_OK;
+  if (bloco->endereco == SIM_DISPLAY)
+  {
+    uint8_t buf[1 + BARRAMENTO_BLOCO];
+    size_t n = 0;
+    if (bloco->prefixo >= 0)
+      buf[n++] = (uint8_t)bloco->prefixo;
+    memcpy(&buf[n], bloco->dados, bloco->n);
+    sim_i2c_aplicar(buf, n + bloco->n);
+  }
+  else if (bloco->endereco == SIM_RTC || bloco->endereco == SIM_NIVEL || bloco->endereco == SIM_TEMPERATURA)
+    ler_escravo(bloco);
+  else
+    status = BARRAMENTO_NACK;
+  barramento_concluir(barramento, status);
+  return porta.ocupado && !porta.travado; // O fim do bloco pode ter iniciado o próximo no mesmo temporizador
+}
+
+static void iniciar(barramento_t *b, const barramento_bloco_t *bloco)
+{
+  (void)b;
+  porta.bloco = *bloco;
+  porta.ocupado = true;
+  if (porta.travado)
+  {
+    cancel_repeating_timer(&porta.fim);
+    return;
+  }
+  // Endereço, prefixo, dados e, na leitura, o endereço de novo e os bytes lidos
+  size_t bytes = (bloco->prefixo >= 0) + bloco->n + (bloco->n_leitura ? 1 + bloco->n_leitura : 0);
+  add_repeating_timer_us(-(int64_t)sim_i2c_duracao_us(porta.i2c, bytes), concluir, NULL, &porta.fim);
+}
+
+static void abortar(barramento_t *b)
+{
+  (void)b;
+  porta.ocupado = false;
+  cancel_repeating_timer(&porta.fim);
+}
+
+static bool recuperar(barramento_t *b)
+{
+  (void)b;
+  busy_wait_us_32(100); // 9 pulsos e o STOP a 100 kHz
+  porta.travado = false;
+  return true;
+}
+
+static const barramento_porta_t porta_sim = {iniciar, abortar, recuperar};
+
+void barramento_i2c_init(barramento_t *b, i2c_inst_t *i2c, uint sda, uint scl, uint baudrate)
+{
+  (void)sda; (void)scl;
+  i2c_init(i2c, baudrate);
+  porta.i2c = i2c;
+  barramento_init(b, &porta_sim, &porta);
+  barramento = b;
+}
+
+// ---------------------------------------------------------------- Carga e falhas
+
+static uint8_t reg_zero = 0;
+static uint8_t leitura_rtc[7], leitura_nivel[2], leitura_temperatura[2];
+static barramento_transacao_t rtc = {.endereco = SIM_RTC, .prefixo = -1, .escrita = &reg_zero, .n_escrita = 1,
+                                     .leitura = leitura_rtc, .n_leitura = 7, .prioridade = BARRAMENTO_ALTA,
+                                     .status = BARRAMENTO_OK};
+static barramento_transacao_t nivel = {.endereco = SIM_NIVEL, .prefixo = -1, .escrita = &reg_zero, .n_escrita = 1,
+                                       .leitura = leitura_nivel, .n_leitura = 2, .prioridade = BARRAMENTO_ALTA,
+                                       .status = BARRAMENTO_OK};
+static barramento_transacao_t temperatura = {.endereco = SIM_TEMPERATURA, .prefixo = -1, .escrita = &reg_zero,
+                                             .n_escrita = 1, .leitura = leitura_temperatura, .n_leitura = 2,
+                                             .prioridade = BARRAMENTO_NORMAL, .status = BARRAMENTO_OK};
+static repeating_timer_t timer_sensores, timer_travar;
+
+// Período 0: cada leitura volta para a fila assim que termina (barramento saturado)
+static void reenviar(barramento_transacao_t *t)
+{
+  barramento_enviar(barramento, t);
+}
+
+static bool ler_sensores(repeating_timer_t *t)
+{
+  (void)t;
+  if (!barramento)
+    return true; // Display ainda não inicializado
+  if (rtc.status != BARRAMENTO_PENDENTE)
+    barramento_enviar(barramento, &rtc);
+  if (nivel.status != BARRAMENTO_PENDENTE)
+    barramento_enviar(barramento, &nivel);
+  if (temperatura.status != BARRAMENTO_PENDENTE)
+    barramento_enviar(barramento, &temperatura);
+  return sensores_periodo_ms > 0; // Saturado: a partir daqui as leituras se reenviam
+}
+
+// Leituras do RTC e do sensor de nível na prioridade alta e da temperatura
+// na normal a cada periodo_ms
+void sim_barramento_sensores(uint32_t periodo_ms)
+{
+  sensores_periodo_ms = periodo_ms;
+  if (periodo_ms == 0)
+  {
+    rtc.concluida = reenviar;
+    nivel.concluida = reenviar;
+    temperatura.concluida = reenviar;
+  }
+  add_repeating_timer_ms(periodo_ms ? periodo_ms : 500, ler_sensores, NULL, &timer_sensores);
+}
+
+static bool travar(repeating_timer_t *t)
+{
+  (void)t;
+  porta.travado = true;
+  travamentos++;
+  if (porta.ocupado)
+    cancel_repeating_timer(&porta.fim); // O bloco em andamento também para
+  return false;
+}
+
+// Um escravo prende SDA no instante dado
+void sim_barramento_travar_em(uint64_t tempo_us)
+{
+  add_repeating_timer_us((int64_t)(tempo_us - sim_agora_us()), travar, NULL, &timer_travar);
+}
+
+// Relatório do gerenciador e critérios das verificações com --sensores e
+// --travar-i2c: sem falhas, toda trava recuperada e, sem travas, nenhuma
+// leitura de prioridade alta esperando mais que um bloco cheio do display
+// e outra leitura. As prioridades normal e baixa também andam: cada uma
+// espera no máximo BARRAMENTO_MAX_SEGUIDAS blocos e mais três (a outra
+// promovida antes dela e o bloco da alta entre as duas promoções).
+bool sim_barramento_verificar()
+{
+  if (!barramento)
+    return true;
+  barramento_relatorio(barramento);
+  bool ok = barramento->falhas == 0 && barramento->recuperacoes >= travamentos;
+  if (sensores_periodo_ms != UINT32_MAX && !travamentos)
+  {
+    uint32_t limite = sim_i2c_duracao_us(porta.i2c, 1 + BARRAMENTO_BLOCO) +
+                      sim_i2c_duracao_us(porta.i2c, 2 + BARRAMENTO_MAX_LEITURA);
+    uint32_t espera = barramento->estatisticas[BARRAMENTO_ALTA].espera_max_us;
+    printf("  espera max da prioridade alta %lu us (limite %lu us)\n", (unsigned long)espera, (unsigned long)limite);
+    ok = ok && espera <= limite;
+
+    uint32_t bloco = sim_i2c_duracao_us(porta.i2c, 1 + BARRAMENTO_BLOCO);
+    uint32_t limite_justica = (BARRAMENTO_MAX_SEGUIDAS + 3) * bloco;
+    for (int p = BARRAMENTO_NORMAL; p < BARRAMENTO_NUM_PRIORIDADES; p++)
+    {
+      const barramento_estatisticas_t *e = &barramento->estatisticas[p];
+      printf("  espera max da prioridade %s %lu us (limite %lu us)\n", p == BARRAMENTO_NORMAL ? "normal" : "baixa",
+             (unsigned long)e->espera_max_us, (unsigned long)limite_justica);
+      ok = ok && e->transacoes > 0 && e->espera_max_us <= limite_justica;
+    }
+  }
+  printf("  %s\n", ok ? "OK" : "FALHOU");
+  return ok;
+}
@@ -0,0 +1,70 @@
+#include "sim.h"
+#include "inc/historico.h"
+#include <string.h>
+
+// Flash do histórico em RAM. Como na NOR real, programar só leva bits de
+// 1 para 0 e apagar volta o setor inteiro para 0xFF.
+#define SIM_FLASH_SETORES 8
+
+static uint8_t flash_ram[SIM_FLASH_SETORES * HISTORICO_SETOR];
+static bool apagada = false;
+static uint32_t escritas = 0, falhar_em = 0;
+
+static void iniciar()
+{
+  if (!apagada)
+  {
+    memset(flash_ram, 0xFF, sizeof(flash_ram));
+    apagada = true;
+  }
+}
+
+// Simula falta de energia: a escrita de número 'n' grava só metade da página
+void sim_flash_falhar_na_escrita(uint32_t n)
+{
+  falhar_em = n;
+}
+
+static void apagar_setor(uint32_t offset)
+{
+  memset(flash_ram + offset, 0xFF, HISTORICO_SETOR);
+  sleep_ms(45); // Tempo típico de apagamento de um setor
+}
+
+static void programar_pagina(uint32_t offset, const uint8_t *pagina)
+{
+  size_t n = HISTORICO_PAGINA;
+  if (++escritas == falhar_em)
+    n /= 2;
+  for (size_t i = 0; i < n; i++)
+    flash_ram[offset + i] &= pagina[i];
+  sleep_us(700); // Tempo típico de programação de uma página
+}
+
+bool sim_flash_carregar(const char *caminho)
+{
+  iniciar();
+  FILE *f = fopen(caminho, "rb");
+  if (!f)
+    return false;
+  size_t n = fread(flash_ram, 1, sizeof(flash_ram), f);
+  fclose(f);
+  return n == sizeof(flash_ram);
+}
+
+bool sim_flash_salvar(const char *caminho)
+{
+  FILE *f = fopen(caminho, "wb");
+  if (!f)
+    return false;
+  size_t n = fwrite(flash_ram, 1, sizeof(flash_ram), f);
+  fclose(f);
+  return n == sizeof(flash_ram);
+}
+
+const historico_flash_t *historico_flash_padrao()
+{
+  static const historico_flash_t flash = {sizeof(flash_ram), flash_ram, apagar_setor, programar_pagina};
+  iniciar();
+  return &flash;
+}
@@ -0,0 +1,376 @@
+#include "sim.h"
+#include "inc/dlog.h"
+#include "inc/latencia.h"
+#include "inc/entrada.h"
+#include "inc/historico.h"
+#include <string.h>
+
+// Pinos e canais usados pelo firmware (Projeto_Final.c)
+#define SIM_BOTAO_A 5
+#define SIM_BOTAO_B 6
+#define SIM_ADC_Y 0
+#define SIM_CENTRO 2047
+
+int firmware_main(void);
+void tarefas_nucleo1(void);
+
+// Gerador próprio: o firmware usa rand() e não deve ter a sequência alterada
+static uint32_t semente = 1;
+static uint32_t sorteio(uint32_t n)
+{
+  semente = semente * 1103515245u + 12345u;
+  return (semente >> 16) % n;
+}
+
+static FILE *gravacao = NULL; // --gravar: entradas gravadas pelo firmware
+static FILE *quadros = NULL;  // --quadros: tempo e hash de cada quadro do display
+static const char *flash = NULL; // --flash: imagem da flash do histórico entre execuções
+static bool barramento = false;  // --sensores/--travar-i2c: verifica o gerenciador do I2C no fim
+
+// Tarefas que no alvo rodam no núcleo 1 ou no host ligado à serial
+static void nucleo1()
+{
+  if (dlog_estacionado())
+    return; // No alvo, parado em WFE durante o repouso
+  dlog_drenar();
+  tarefas_nucleo1();
+
+  if (gravacao)
+  {
+    uint8_t bloco[256];
+    size_t n;
+    while ((n = entrada_drenar(bloco, sizeof(bloco))) > 0)
+      fwrite(bloco, 1, n, gravacao);
+  }
+}
+
+// No alvo o núcleo 1 roda a cada DLOG_PERIODO_MS; aqui, num temporizador virtual
+static bool ciclo_nucleo1(repeating_timer_t *t)
+{
+  (void)t;
+  nucleo1();
+  return true;
+}
+
+// FNV-1a do conteúdo do display: quadros iguais têm o mesmo hash
+static void registrar_quadro(const uint8_t *display)
+{
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < SIM_LARGURA * SIM_PAGINAS; i++)
+    h = (h ^ display[i]) * 16777619u;
+  fprintf(quadros, "%llu %08x\n", (unsigned long long)sim_agora_us(), (unsigned)h);
+}
+
+extern bool menu; // Projeto_Final.c
+
+// O simulador conhece o instante físico de cada entrada; o firmware só a
+// percebe quando lê o pino ou o ADC, então a medição começa aqui. O
+// joystick só é lido com o menu aberto: na tela inicial ele não muda nada
+// no painel e não abre medição.
+static void marcar_entrada(const sim_evento_t *ev)
+{
+  if (ev->tipo == SIM_EV_GPIO && ev->valor == 0)
+    latencia_entrada_em(LATENCIA_BOTAO, (uint32_t)ev->tempo_us);
+  else if (ev->tipo == SIM_EV_ADC && menu && (ev->valor < SIM_CENTRO - 500 || ev->valor > SIM_CENTRO + 500))
+    latencia_entrada_em(LATENCIA_JOYSTICK, (uint32_t)ev->tempo_us);
+}
+
+static void fim_latencia()
+{
+  nucleo1(); // Descarrega o que ainda estiver pendente
+  latencia_relatorio();
+  bool barramento_ok = !barramento || sim_barramento_verificar();
+  if (gravacao)
+    fclose(gravacao);
+  if (quadros)
+    fclose(quadros);
+  if (flash && !sim_flash_salvar(flash))
+    perror(flash);
+  fflush(stdout);
+  exit(latencia_dentro_orcamento() && barramento_ok ? 0 : 1);
+}
+
+// Sessão sintética: abre o menu com o botão B e navega com o joystick
+static void cenario_latencia(uint32_t segundos)
+{
+  uint64_t t = 3000000; // Depois da inicialização (2 s de espera + som)
+  uint64_t fim = (uint64_t)segundos * 1000000;
+
+  while (t < fim)
+  {
+    if (sorteio(3) == 0)
+    {
+      sim_agendar(t, SIM_EV_GPIO, SIM_BOTAO_B, 0);
+      sim_agendar(t + 80000, SIM_EV_GPIO, SIM_BOTAO_B, 1);
+    }
+    else
+    {
+      sim_agendar(t, SIM_EV_ADC, SIM_ADC_Y, sorteio(2) ? 200 : 3900);
+      sim_agendar(t + 350000, SIM_EV_ADC, SIM_ADC_Y, SIM_CENTRO);
+    }
+    t += 600000 + sorteio(1000) * 1000;
+  }
+  sim_agendar(fim, SIM_EV_FIM, 0, 0);
+}
+
+// Sem entradas: só o que chegar pela serial (--comando, --serial)
+static void cenario_ocioso(uint32_t segundos)
+{
+  sim_agendar((uint64_t)segundos * 1000000, SIM_EV_FIM, 0, 0);
+}
+
+// Histórico sem o firmware: monta a flash simulada (--flash, --falhar-escrita),
+// grava n eventos sorteados, um a cada até 10 min, e exporta como o comando
+// 'H'. Cada evento gravado sai antes numa linha REGISTRO, para
+// tools/historico_decode.py --testar-simulador comparar com a exportação.
+static int cenario_historico(uint32_t n)
+{
+  historico_t h;
+  historico_montar(&h, historico_flash_padrao());
+  printf("MONTADO boot %lu setor %lu\n", (unsigned long)h.boot, (unsigned long)h.seq);
+
+  bool ok = true;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    sleep_ms(1000 * (1 + sorteio(600)));
+    historico_evento_t ev = {.tipo = sorteio(4) ? HISTORICO_ALIMENTACAO : HISTORICO_ALERTA,
+                             .estacao = sorteio(3),
+                             .flags = sorteio(2) ? HISTORICO_AUTOMATICO : 0,
+                             .racao_pedida = 10 + sorteio(300),
+                             .agua_pedida = 10 + sorteio(500)};
+    if (ev.tipo == HISTORICO_ALERTA)
+    {
+      // Estoque disponível menor que o pedido em ao menos um dos dois
+      ev.flags |= (1 + sorteio(3)) << 1;
+      ev.racao_real = ev.flags & HISTORICO_FALTA_RACAO ? sorteio(ev.racao_pedida) : ev.racao_pedida + sorteio(1000);
+      ev.agua_real = ev.flags & HISTORICO_FALTA_AGUA ? sorteio(ev.agua_pedida) : ev.agua_pedida + sorteio(1000);
+    }
+    else
+    {
+      // A balança e o fluxômetro erram alguns gramas e ml para os dois lados
+      ev.racao_real = ev.racao_pedida + sorteio(7) - 3;
+      ev.agua_real = ev.agua_pedida + sorteio(11) - 5;
+    }
+    uint32_t tempo_s = time_us_64() / 1000000; // Antes de um eventual apagamento de setor
+    bool gravou = historico_registrar(&h, &ev);
+    ok = ok && gravou;
+    printf("REGISTRO %lu %lu %d %u %u %u %u %u %u%s\n", (unsigned long)h.boot, (unsigned long)tempo_s, ev.tipo, ev.estacao, ev.flags, ev.racao_pedida, ev.racao_real,
+           ev.agua_pedida, ev.agua_real, gravou ? "" : " FALHOU");
+  }
+
+  historico_exportar(&h);
+  if (flash && !sim_flash_salvar(flash))
+  {
+    perror(flash);
+    ok = false;
+  }
+  return ok ? 0 : 1;
+}
+
+static uint64_t ler_varint(FILE *f, bool *ok)
+{
+  uint64_t v = 0;
+  for (int desloc = 0; desloc < 70; desloc += 7)
+  {
+    int c = fgetc(f);
+    if (c == EOF)
+    {
+      *ok = false;
+      return 0;
+    }
+    v |= (uint64_t)(c & 0x7F) << desloc;
+    if (!(c & 0x80))
+      return v;
+  }
+  *ok = false;
+  return 0;
+}
+
+// Agenda as entradas de uma gravação (formato em inc/entrada.h) no relógio virtual
+static void cenario_replay(const char *caminho)
+{
+  FILE *f = fopen(caminho, "rb");
+  char cab[4];
+  if (!f || fread(cab, 1, 4, f) != 4 || memcmp(cab, ENTRADA_CABECALHO, 4) != 0)
+  {
+    fprintf(stderr, "sim: %s nao e uma gravacao de entradas\n", caminho);
+    exit(2);
+  }
+
+  uint64_t t = 0;
+  size_t n = 0;
+  int c;
+  while ((c = fgetc(f)) != EOF)
+  {
+    bool ok = true;
+    t += ler_varint(f, &ok);
+    uint tipo = c >> 6, canal = c & 0x3F;
+    uint16_t valor = tipo == ENTRADA_GPIO_ALTO;
+    if (ok && tipo == ENTRADA_ADC)
+    {
+      int lo = fgetc(f), hi = fgetc(f);
+      ok = hi != EOF;
+      valor = lo | hi << 8;
+    }
+    if (!ok || tipo > ENTRADA_ADC)
+    {
+      fprintf(stderr, "sim: gravacao truncada ou corrompida apos %zu registros\n", n);
+      break;
+    }
+    sim_agendar(t, tipo == ENTRADA_ADC ? SIM_EV_ADC : SIM_EV_GPIO, canal, valor);
+    n++;
+  }
+  fclose(f);
+
+  // Deixa o firmware terminar de reagir à última entrada
+  sim_agendar(t + 5000000, SIM_EV_FIM, 0, 0);
+  fprintf(stderr, "sim: %zu entradas, %.1f s de sessao\n", n, t / 1e6);
+}
+
+static void uso()
+{
+  fprintf(stderr,
+          "uso: simulador latencia [segundos] [semente] [opcoes]\n"
+          "     simulador replay <gravacao.bin> [opcoes]\n"
+          "     simulador ocioso [segundos] [opcoes]\n"
+          "     simulador historico <eventos> [semente] [--flash <arq>] [--falhar-escrita <n>]\n"
+          "  latencia: sessao sintetica com botao B e joystick no menu.\n"
+          "  replay:   reproduz uma gravacao de entradas (inc/entrada.h) no relogio virtual.\n"
+          "  ocioso:   sem entradas, so a serial (ex.: com --serial).\n"
+          "  historico: sem o firmware, grava eventos sorteados no historico da flash\n"
+          "            simulada e o exporta; falha se alguma gravacao falhar.\n"
+          "  Os outros terminam com o relatorio de latencia e falham (codigo 1) se o\n"
+          "  p99 passar de LATENCIA_ORCAMENTO_P99_MS.\n"
+          "opcoes:\n"
+          "  --gravar <arquivo>   grava as entradas vistas pelo firmware\n"
+          "  --quadros <arquivo>  grava tempo e hash de cada quadro do display\n"
+          "  --flash <arquivo>    carrega e salva a flash do historico (persiste entre execucoes)\n"
+          "  --falhar-escrita <n> corta a n-esima escrita de pagina da flash pela metade\n"
+          "  --comando <s> <txt>  envia o texto pela serial no segundo s (ex.: --comando 60 H)\n"
+          "  --serial <s> <arq>   envia o conteudo binario do arquivo pela serial no segundo s\n"
+          "  --botao <s> <gpio> <ms> aperta o botao do pino no segundo s e solta depois de ms\n"
+          "  --adc <s> <canal> <v> muda a leitura do canal do ADC (joystick) no segundo s\n"
+          "  --sensores <ms>      le o RTC e o sensor de nivel no I2C a cada ms (0: sem parar)\n"
+          "  --travar-i2c <s>     um escravo prende SDA no segundo s (ate a recuperacao)\n"
+          "  Com --sensores ou --travar-i2c, falha tambem se o gerenciador do I2C\n"
+          "  registrar falhas, nao recuperar uma trava ou deixar uma leitura esperando\n"
+          "  mais que um bloco do display.\n");
+  exit(2);
+}
+
+static FILE *abrir(const char *caminho, const char *modo)
+{
+  FILE *f = fopen(caminho, modo);
+  if (!f)
+  {
+    perror(caminho);
+    exit(2);
+  }
+  return f;
+}
+
+int main(int argc, char **argv)
+{
+  const char *pos[3] = {NULL, NULL, NULL};
+  int npos = 0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--gravar") == 0 && i + 1 < argc)
+    {
+      gravacao = abrir(argv[++i], "wb");
+      fwrite(ENTRADA_CABECALHO, 1, 4, gravacao);
+    }
+    else if (strcmp(argv[i], "--quadros") == 0 && i + 1 < argc)
+    {
+      quadros = abrir(argv[++i], "w");
+      sim_ao_quadro = registrar_quadro;
+    }
+    else if (strcmp(argv[i], "--flash") == 0 && i + 1 < argc)
+    {
+      flash = argv[++i];
+      sim_flash_carregar(flash);
+    }
+    else if (strcmp(argv[i], "--falhar-escrita") == 0 && i + 1 < argc)
+    {
+      sim_flash_falhar_na_escrita(strtoul(argv[++i], NULL, 0));
+    }
+    else if (strcmp(argv[i], "--comando") == 0 && i + 2 < argc)
+    {
+      uint64_t t = strtod(argv[++i], NULL) * 1e6;
+      for (const char *c = argv[++i]; *c; c++)
+        sim_agendar(t++, SIM_EV_SERIAL, 0, (uint8_t)*c);
+    }
+    else if (strcmp(argv[i], "--serial") == 0 && i + 2 < argc)
+    {
+      uint64_t t = strtod(argv[++i], NULL) * 1e6;
+      FILE *f = abrir(argv[++i], "rb");
+      int c;
+      while ((c = fgetc(f)) != EOF)
+        sim_agendar(t++, SIM_EV_SERIAL, 0, c);
+      fclose(f);
+    }
+    else if (strcmp(argv[i], "--botao") == 0 && i + 3 < argc)
+    {
+      uint64_t t = strtod(argv[++i], NULL) * 1e6;
+      uint8_t pino = strtoul(argv[++i], NULL, 0);
+      sim_agendar(t, SIM_EV_GPIO, pino, 0);
+      sim_agendar(t + strtoul(argv[++i], NULL, 0) * 1000ull, SIM_EV_GPIO, pino, 1);
+    }
+    else if (strcmp(argv[i], "--adc") == 0 && i + 3 < argc)
+    {
+      uint64_t t = strtod(argv[++i], NULL) * 1e6;
+      uint8_t canal = strtoul(argv[++i], NULL, 0);
+      sim_agendar(t, SIM_EV_ADC, canal, strtoul(argv[++i], NULL, 0));
+    }
+    else if (strcmp(argv[i], "--sensores") == 0 && i + 1 < argc)
+    {
+      sim_barramento_sensores(strtoul(argv[++i], NULL, 0));
+      barramento = true;
+    }
+    else if (strcmp(argv[i], "--travar-i2c") == 0 && i + 1 < argc)
+    {
+      sim_barramento_travar_em(strtod(argv[++i], NULL) * 1e6);
+      barramento = true;
+    }
+    else if (npos < 3)
+      pos[npos++] = argv[i];
+    else
+      uso();
+  }
+  if (!npos)
+    uso();
+  if (strcmp(pos[0], "historico") == 0 && pos[1])
+  {
+    if (pos[2])
+      semente = strtoul(pos[2], NULL, 0);
+    return cenario_historico(strtoul(pos[1], NULL, 0));
+  }
+
+  static repeating_timer_t timer_nucleo1;
+  add_repeating_timer_ms(DLOG_PERIODO_MS, ciclo_nucleo1, NULL, &timer_nucleo1);
+  sim_ao_evento = marcar_entrada;
+  sim_ao_fim = fim_latencia;
+  srand(1);
+
+  if (strcmp(pos[0], "latencia") == 0)
+  {
+    if (pos[2])
+      semente = strtoul(pos[2], NULL, 0);
+    cenario_latencia(pos[1] ? strtoul(pos[1], NULL, 0) : 300);
+  }
+  else if (strcmp(pos[0], "replay") == 0 && pos[1])
+  {
+    cenario_replay(pos[1]);
+  }
+  else if (strcmp(pos[0], "ocioso") == 0)
+  {
+    cenario_ocioso(pos[1] ? strtoul(pos[1], NULL, 0) : 30);
+  }
+  else
+  {
+    uso();
+  }
+
+  return firmware_main();
+}
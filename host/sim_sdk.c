@@ -0,0 +1,467 @@
+#include "sim.h"
+#include <string.h>
+
+// Relógio virtual: só avança em sleep/espera ativa e nas transferências I2C
+static uint64_t agora_us = 0;
+
+static sim_evento_t eventos[SIM_MAX_EVENTOS];
+static size_t num_eventos = 0, proximo_evento = 0;
+
+static uint8_t serial[256];
+static size_t serial_ini = 0, serial_fim = 0;
+static void (*serial_disponivel)(void *) = NULL;
+static void *serial_param = NULL;
+
+void (*sim_ao_evento)(const sim_evento_t *ev) = NULL;
+void (*sim_ao_quadro)(const uint8_t *display) = NULL;
+void (*sim_ao_fim)() = NULL;
+
+pio_hw_t sim_pio0, sim_pio1;
+clocks_hw_t sim_clocks_hw = {0xFFFFFFFF, 0xFFFFFFFF};
+armv6m_scb_hw_t sim_scb_hw;
+const pio_program_t ws2812_program, ws2812_parallel_program;
+
+// ---------------------------------------------------------------- GPIO/ADC
+
+#define NUM_GPIOS 30
+
+static bool nivel[NUM_GPIOS];
+static uint32_t irq_eventos[NUM_GPIOS];
+static gpio_irq_callback_t irq_callback = NULL;
+static bool interrupcoes = true;
+static uint32_t irq_pendentes[NUM_GPIOS]; // Bordas vistas com as interrupções mascaradas
+static uint16_t adc_valor[5] = {2047, 2047, 2047, 2047, 2047};
+static uint adc_canal = 0;
+
+static void aplicar(const sim_evento_t *ev)
+{
+  if (sim_ao_evento)
+    sim_ao_evento(ev);
+
+  switch (ev->tipo)
+  {
+  case SIM_EV_GPIO:
+  {
+    bool antes = nivel[ev->canal];
+    bool depois = ev->valor != 0;
+    nivel[ev->canal] = depois;
+    uint32_t borda = antes && !depois ? GPIO_IRQ_EDGE_FALL : !antes && depois ? GPIO_IRQ_EDGE_RISE : 0;
+    if (borda & irq_eventos[ev->canal] && irq_callback)
+    {
+      if (interrupcoes)
+        irq_callback(ev->canal, borda);
+      else
+        irq_pendentes[ev->canal] |= borda;
+    }
+    break;
+  }
+  case SIM_EV_ADC:
+    if (ev->canal < 5)
+      adc_valor[ev->canal] = ev->valor;
+    break;
+  case SIM_EV_SERIAL:
+  {
+    uint8_t b = ev->valor;
+    sim_serial_entrada(&b, 1);
+    break;
+  }
+  case SIM_EV_FIM:
+    if (sim_ao_fim)
+      sim_ao_fim();
+    exit(0);
+  }
+}
+
+// ---------------------------------------------------------------- Temporizadores
+
+static repeating_timer_t *temporizadores = NULL;
+
+static repeating_timer_t *proximo_temporizador()
+{
+  repeating_timer_t *prox = NULL;
+  for (repeating_timer_t *t = temporizadores; t; t = t->prox)
+    if (t->ativo && (!prox || t->proximo < prox->proximo))
+      prox = t;
+  return prox;
+}
+
+// Avança o relógio até 'ate', disparando eventos e temporizadores no caminho
+static void avancar_ate(uint64_t ate)
+{
+  while (true)
+  {
+    uint64_t t_ev = proximo_evento < num_eventos ? eventos[proximo_evento].tempo_us : UINT64_MAX;
+    repeating_timer_t *tmp = proximo_temporizador();
+    uint64_t t_tmp = tmp ? tmp->proximo : UINT64_MAX;
+
+    if (t_ev > ate && t_tmp > ate)
+      break;
+    if (t_ev <= t_tmp)
+    {
+      if (t_ev > agora_us)
+        agora_us = t_ev;
+      aplicar(&eventos[proximo_evento++]);
+    }
+    else
+    {
+      if (t_tmp > agora_us)
+        agora_us = t_tmp;
+      tmp->proximo += tmp->delay_us;
+      if (!tmp->callback(tmp))
+        tmp->ativo = false;
+    }
+  }
+  agora_us = ate;
+}
+
+uint64_t sim_agora_us()
+{
+  return agora_us;
+}
+
+void sim_agendar(uint64_t tempo_us, sim_evento_tipo_t tipo, uint8_t canal, uint16_t valor)
+{
+  if (num_eventos == SIM_MAX_EVENTOS)
+  {
+    fprintf(stderr, "sim: fila de eventos cheia\n");
+    exit(2);
+  }
+  // Inserção ordenada; eventos com o mesmo tempo mantêm a ordem de agendamento
+  size_t i = num_eventos++;
+  while (i > proximo_evento && eventos[i - 1].tempo_us > tempo_us)
+  {
+    eventos[i] = eventos[i - 1];
+    i--;
+  }
+  eventos[i] = (sim_evento_t){tempo_us, tipo, canal, valor};
+}
+
+void sim_serial_entrada(const uint8_t *dados, size_t n)
+{
+  for (size_t i = 0; i < n && serial_fim - serial_ini < sizeof(serial); i++)
+    serial[serial_fim++ % sizeof(serial)] = dados[i];
+  if (n && serial_disponivel)
+    serial_disponivel(serial_param);
+}
+
+uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+absolute_time_t get_absolute_time(void) { return agora_us; }
+uint32_t time_us_32(void) { return (uint32_t)agora_us; }
+uint64_t time_us_64(void) { return agora_us; }
+absolute_time_t make_timeout_time_us(uint64_t us) { return agora_us + us; }
+absolute_time_t make_timeout_time_ms(uint32_t ms) { return agora_us + ms * 1000ull; }
+bool time_reached(absolute_time_t t) { return agora_us >= t; }
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return (int64_t)(to - from); }
+void sleep_ms(uint32_t ms) { avancar_ate(agora_us + ms * 1000ull); }
+void sleep_us(uint64_t us) { avancar_ate(agora_us + us); }
+void busy_wait_us_32(uint32_t us) { avancar_ate(agora_us + us); }
+void tight_loop_contents(void) { avancar_ate(agora_us + 1); }
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out)
+{
+  return add_repeating_timer_us((int64_t)delay_ms * 1000, callback, user_data, out);
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out)
+{
+  if (delay_us < 0)
+    delay_us = -delay_us;
+  out->delay_us = delay_us;
+  out->callback = callback;
+  out->user_data = user_data;
+  out->proximo = agora_us + delay_us;
+  out->ativo = true;
+  for (repeating_timer_t *t = temporizadores; t; t = t->prox)
+    if (t == out)
+      return true;
+  out->prox = temporizadores;
+  temporizadores = out;
+  return true;
+}
+
+bool cancel_repeating_timer(repeating_timer_t *timer)
+{
+  bool estava = timer->ativo;
+  timer->ativo = false;
+  return estava;
+}
+
+// ---------------------------------------------------------------- Núcleo/IRQ
+
+uint get_core_num(void) { return 0; }
+uint32_t save_and_disable_interrupts(void)
+{
+  bool antes = interrupcoes;
+  interrupcoes = false;
+  return antes;
+}
+// Ao desmascarar, as bordas pendentes são atendidas como no NVIC
+void restore_interrupts(uint32_t status)
+{
+  interrupcoes = status != 0;
+  for (uint g = 0; interrupcoes && g < NUM_GPIOS; g++)
+  {
+    uint32_t borda = irq_pendentes[g];
+    irq_pendentes[g] = 0;
+    if (borda && irq_callback)
+      irq_callback(g, borda);
+  }
+}
+// Dorme até o próximo evento ou temporizador. Os temporizadores disparam
+// mesmo mascarados, o que equivale a atendê-los logo após o WFI.
+void __wfi(void)
+{
+  uint64_t t_ev = proximo_evento < num_eventos ? eventos[proximo_evento].tempo_us : UINT64_MAX;
+  repeating_timer_t *tmp = proximo_temporizador();
+  uint64_t t = tmp && tmp->proximo < t_ev ? tmp->proximo : t_ev;
+  avancar_ate(t > agora_us && t != UINT64_MAX ? t : agora_us + 1);
+}
+void __wfe(void) { avancar_ate(agora_us + 1); }
+// Como o __wfi, mas sem passar do prazo
+bool best_effort_wfe_or_timeout(absolute_time_t prazo)
+{
+  uint64_t t_ev = proximo_evento < num_eventos ? eventos[proximo_evento].tempo_us : UINT64_MAX;
+  repeating_timer_t *tmp = proximo_temporizador();
+  uint64_t t = tmp && tmp->proximo < t_ev ? tmp->proximo : t_ev;
+  if (t > prazo)
+    t = prazo;
+  avancar_ate(t > agora_us ? t : agora_us + 1);
+  return time_reached(prazo);
+}
+void critical_section_init(critical_section_t *cs) { cs->salvo = 1; }
+void critical_section_enter_blocking(critical_section_t *cs) { cs->salvo = save_and_disable_interrupts(); }
+void critical_section_exit(critical_section_t *cs) { restore_interrupts(cs->salvo); }
+void __sev(void) {}
+void __dmb(void) {}
+void multicore_launch_core1(void (*entry)(void)) { (void)entry; } // As tarefas do núcleo 1 são agendadas pelo simulador
+bool flash_safe_execute_core_init(void) { return true; }
+bool multicore_lockout_start_timeout_us(uint64_t timeout_us) { (void)timeout_us; return true; }
+bool multicore_lockout_end_timeout_us(uint64_t timeout_us) { (void)timeout_us; return true; }
+
+// ---------------------------------------------------------------- stdio
+
+bool stdio_init_all(void) { return true; }
+void stdio_flush(void) { fflush(stdout); }
+int putchar_raw(int c) { return putchar(c); }
+int stdio_put_string(const char *s, int len, bool newline, bool cr_translation)
+{
+  (void)cr_translation;
+  fwrite(s, 1, len, stdout);
+  if (newline)
+    putchar('\n');
+  return len;
+}
+
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param)
+{
+  serial_disponivel = fn;
+  serial_param = param;
+}
+
+int getchar_timeout_us(uint32_t timeout_us)
+{
+  if (serial_ini == serial_fim)
+  {
+    avancar_ate(agora_us + timeout_us);
+    return PICO_ERROR_TIMEOUT;
+  }
+  return serial[serial_ini++ % sizeof(serial)];
+}
+
+// ---------------------------------------------------------------- GPIO/ADC/PWM
+
+void gpio_init(uint gpio) { nivel[gpio] = false; }
+void gpio_set_dir(uint gpio, bool out) { (void)gpio; (void)out; }
+void gpio_pull_up(uint gpio) { nivel[gpio] = true; } // Botões soltos leem nível alto
+void gpio_put(uint gpio, bool value) { nivel[gpio] = value; }
+bool gpio_get(uint gpio) { return nivel[gpio]; }
+void gpio_set_function(uint gpio, enum gpio_function fn) { (void)gpio; (void)fn; }
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled)
+{
+  if (enabled)
+    irq_eventos[gpio] |= events;
+  else
+    irq_eventos[gpio] &= ~events;
+}
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback)
+{
+  gpio_set_irq_enabled(gpio, events, enabled);
+  irq_callback = callback;
+}
+
+void adc_init(void) {}
+void adc_gpio_init(uint gpio) { (void)gpio; }
+void adc_select_input(uint input) { adc_canal = input; }
+uint16_t adc_read(void) { return adc_valor[adc_canal % 5]; }
+
+uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1) & 7; }
+void pwm_set_wrap(uint slice, uint16_t wrap) { (void)slice; (void)wrap; }
+void pwm_set_clkdiv(uint slice, float div) { (void)slice; (void)div; }
+void pwm_set_clkdiv_int_frac(uint slice, uint8_t integer, uint8_t fract) { (void)slice; (void)integer; (void)fract; }
+void pwm_set_gpio_level(uint gpio, uint16_t level) { (void)gpio; (void)level; }
+void pwm_set_enabled(uint slice, bool enabled) { (void)slice; (void)enabled; }
+
+// ---------------------------------------------------------------- PIO/DMA/clocks
+
+uint pio_add_program(PIO pio, const pio_program_t *program) { (void)pio; (void)program; return 0; }
+int pio_claim_unused_sm(PIO pio, bool required) { (void)pio; (void)required; return 0; }
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) { pio->txf[sm] = data; }
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) { (void)pio; (void)sm; (void)enabled; }
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div) { (void)pio; (void)sm; (void)div; }
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t div_int, uint8_t div_frac) { (void)pio; (void)sm; (void)div_int; (void)div_frac; }
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx) { (void)pio; (void)is_tx; return sm; }
+
+int dma_claim_unused_channel(bool required) { (void)required; static int prox = 0; return prox++; }
+dma_channel_config dma_channel_get_default_config(uint channel) { (void)channel; return (dma_channel_config){0}; }
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) { (void)c; (void)size; }
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) { (void)c; (void)incr; }
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) { (void)c; (void)incr; }
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) { (void)c; (void)dreq; }
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+  (void)channel; (void)config; (void)write_addr; (void)read_addr; (void)transfer_count; (void)trigger;
+}
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count)
+{
+  (void)channel; (void)read_addr; (void)transfer_count; // Transferência instantânea
+}
+bool dma_channel_is_busy(uint channel) { (void)channel; return false; }
+void dma_channel_wait_for_finish_blocking(uint channel) { (void)channel; }
+
+// clk_sys e clk_peri andam juntos, como após set_sys_clock_khz no alvo
+static uint32_t clk_sys_hz = 125000000;
+uint32_t clock_get_hz(enum clock_index clk_index) { return clk_index == clk_sys || clk_index == clk_peri ? clk_sys_hz : 48000000; }
+bool set_sys_clock_khz(uint32_t freq_khz, bool required)
+{
+  (void)required;
+  clk_sys_hz = freq_khz * 1000;
+  return true;
+}
+
+// ---------------------------------------------------------------- I2C + SSD1306
+
+// O divisor do I2C é calculado a partir de clk_peri: se o clock mudar sem um
+// novo i2c_set_baudrate, a taxa efetiva muda junto
+struct i2c_inst { uint baudrate; uint32_t clk_peri_hz; };
+i2c_inst_t sim_i2c0, sim_i2c1;
+
+static uint8_t display[SIM_LARGURA * SIM_PAGINAS];
+static bool display_ligado = false;
+static uint8_t modo_enderecamento = 0x02; // Paginado, padrão do SSD1306
+static uint8_t col_ini = 0, col_fim = SIM_LARGURA - 1, pag_ini = 0, pag_fim = SIM_PAGINAS - 1;
+static uint8_t col = 0, pag = 0;
+static uint8_t cmd_pendente = 0, cmd_args = 0, cmd_buf[2];
+static bool janela_completa = false; // O endereço voltou ao início da janela
+
+const uint8_t *sim_display() { return display; }
+bool sim_display_ligado() { return display_ligado; }
+
+static uint cmd_num_args(uint8_t c)
+{
+  switch (c)
+  {
+  case 0x21: case 0x22: return 2;
+  case 0x20: case 0x81: case 0xA8: case 0xD3: case 0xDA: case 0xD5: case 0xD9: case 0xDB: case 0x8D: return 1;
+  default: return 0;
+  }
+}
+
+static void ssd1306_comando(uint8_t b)
+{
+  if (cmd_args)
+  {
+    cmd_buf[cmd_num_args(cmd_pendente) - cmd_args--] = b;
+    if (cmd_args)
+      return;
+    switch (cmd_pendente)
+    {
+    case 0x20: modo_enderecamento = cmd_buf[0] & 3; break;
+    case 0x21: col_ini = col = cmd_buf[0] & 0x7F; col_fim = cmd_buf[1] & 0x7F; break;
+    case 0x22: pag_ini = pag = cmd_buf[0] & 7; pag_fim = cmd_buf[1] & 7; break;
+    }
+    return;
+  }
+  if (b == 0xAE || b == 0xAF)
+    display_ligado = b & 1;
+  cmd_pendente = b;
+  cmd_args = cmd_num_args(b);
+}
+
+// Escreve na GDDRAM seguindo o modo de endereçamento configurado
+static void ssd1306_dado(uint8_t b)
+{
+  display[col * SIM_PAGINAS + pag] = b; // Mesmo layout coluna a coluna do ram_buffer do driver
+  if (modo_enderecamento == 0x01)
+  {
+    if (pag++ >= pag_fim)
+    {
+      pag = pag_ini;
+      janela_completa = col >= col_fim;
+      col = col >= col_fim ? col_ini : col + 1;
+    }
+  }
+  else if (col++ >= col_fim)
+  {
+    col = col_ini;
+    janela_completa = pag >= pag_fim;
+    pag = pag >= pag_fim ? pag_ini : pag + 1;
+  }
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate)
+{
+  i2c->clk_peri_hz = clk_sys_hz;
+  return i2c->baudrate = baudrate;
+}
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) { return i2c_set_baudrate(i2c, baudrate); }
+
+// Tempo no barramento: endereço + len bytes, 9 bits por byte
+uint64_t sim_i2c_duracao_us(i2c_inst_t *i2c, size_t len)
+{
+  uint64_t baud = i2c->baudrate ? (uint64_t)i2c->baudrate * clk_sys_hz / i2c->clk_peri_hz : 100000;
+  return (len + 1) * 9ull * 1000000 / baud;
+}
+
+// Aplica ao display uma escrita que terminou agora. Um quadro é registrado
+// quando uma escrita de dados completa a janela de endereços, seja numa
+// transferência só ou em blocos do gerenciador do barramento.
+void sim_i2c_aplicar(const uint8_t *src, size_t len)
+{
+  if (len == 0)
+    return;
+  janela_completa = false;
+
+  // Byte de controle do SSD1306: 0x80 = um comando, 0x00 = comandos, 0x40 = dados
+  if (src[0] == 0x40)
+  {
+    for (size_t i = 1; i < len; i++)
+      ssd1306_dado(src[i]);
+  }
+  else
+  {
+    for (size_t i = 1; i < len; i++)
+      ssd1306_comando(src[i]);
+  }
+
+  if (janela_completa && sim_ao_quadro)
+    sim_ao_quadro(display);
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+  (void)addr; (void)nostop;
+  if (len == 0)
+    return 0;
+  avancar_ate(agora_us + sim_i2c_duracao_us(i2c, len));
+  sim_i2c_aplicar(src, len);
+  return (int)len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+  (void)addr; (void)nostop;
+  memset(dst, 0, len);
+  avancar_ate(agora_us + sim_i2c_duracao_us(i2c, len));
+  return (int)len;
+}
@@ -0,0 +1,229 @@
+#include "barramento.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *const nomes[BARRAMENTO_NUM_PRIORIDADES] = {"alta", "normal", "baixa"};
+
+void barramento_init(barramento_t *b, const barramento_porta_t *porta, void *ctx)
+{
+  memset(b, 0, sizeof(*b));
+  b->porta = porta;
+  b->ctx = ctx;
+  critical_section_init(&b->trava);
+}
+
+// Próxima transação a ganhar o barramento. Chamada com a trava.
+static barramento_transacao_t *escolher(barramento_t *b)
+{
+  int p = -1, promovida = -1;
+  for (int q = 0; q < BARRAMENTO_NUM_PRIORIDADES; q++)
+  {
+    if (!b->filas[q].primeira)
+    {
+      b->saltos[q] = 0; // Só conta enquanto espera
+      continue;
+    }
+    if (p < 0)
+      p = q; // A mais alta com trabalho
+    else if (b->saltos[q] >= BARRAMENTO_MAX_SEGUIDAS && (promovida < 0 || b->saltos[q] > b->saltos[promovida]))
+      promovida = q; // A mais saltada; no empate, a de maior prioridade
+  }
+  if (p < 0)
+    return NULL;
+
+  if (promovida >= 0 && !b->promoveu)
+    p = promovida;
+  b->promoveu = p == promovida;
+  for (int q = 0; q < BARRAMENTO_NUM_PRIORIDADES; q++)
+    if (q != p && b->filas[q].primeira)
+      b->saltos[q]++;
+  b->saltos[p] = 0;
+  return b->filas[p].primeira;
+}
+
+// Entrega o próximo bloco à porta se o barramento estiver livre. Chamada com a trava.
+static void iniciar_proximo(barramento_t *b)
+{
+  if (b->ativa || b->pausas || b->recuperando)
+    return;
+  barramento_transacao_t *t = escolher(b);
+  if (!t)
+    return;
+
+  uint32_t agora = time_us_32();
+  if (t->enviados == 0 && t->tentativas == 0)
+  {
+    barramento_estatisticas_t *e = &b->estatisticas[t->prioridade];
+    uint32_t espera = agora - t->enfileirada_us;
+    e->espera_soma_us += espera;
+    if (espera > e->espera_max_us)
+      e->espera_max_us = espera;
+  }
+
+  // A leitura vai no último bloco, logo depois da escrita
+  uint16_t resto = t->n_escrita - t->enviados;
+  uint16_t n = resto > BARRAMENTO_BLOCO ? BARRAMENTO_BLOCO : resto;
+  bool ultimo = n == resto;
+  b->bloco = (barramento_bloco_t){t->endereco, t->prefixo, t->escrita + t->enviados, n,
+                                  ultimo ? t->leitura : NULL, ultimo ? t->n_leitura : 0};
+  b->ativa = t;
+  b->bloco_inicio_us = agora;
+  b->blocos++;
+  b->porta->iniciar(b, &b->bloco);
+}
+
+// Tira a transação da frente da fila dela e registra o fim. Chamada com a trava.
+static void encerrar(barramento_t *b, barramento_transacao_t *t, barramento_status_t status)
+{
+  b->filas[t->prioridade].primeira = t->proxima;
+  if (!t->proxima)
+    b->filas[t->prioridade].ultima = NULL;
+
+  barramento_estatisticas_t *e = &b->estatisticas[t->prioridade];
+  uint32_t duracao = time_us_32() - t->enfileirada_us;
+  e->transacoes++;
+  if (duracao > e->duracao_max_us)
+    e->duracao_max_us = duracao;
+  if (status != BARRAMENTO_OK)
+    b->falhas++;
+  t->status = status;
+}
+
+// Enfileira uma transação (de qualquer núcleo ou IRQ). A transação e os
+// buffers dela precisam continuar válidos até o fim.
+void barramento_enviar(barramento_t *b, barramento_transacao_t *t)
+{
+  t->proxima = NULL;
+  t->enviados = 0;
+  t->tentativas = 0;
+  t->enfileirada_us = time_us_32();
+  if (t->prioridade >= BARRAMENTO_NUM_PRIORIDADES)
+    t->prioridade = BARRAMENTO_BAIXA;
+  if ((!t->n_escrita && !t->n_leitura) || t->n_leitura > BARRAMENTO_MAX_LEITURA)
+  {
+    t->status = BARRAMENTO_ERRO;
+    if (t->concluida)
+      t->concluida(t);
+    return;
+  }
+  t->status = BARRAMENTO_PENDENTE;
+
+  critical_section_enter_blocking(&b->trava);
+  if (b->filas[t->prioridade].ultima)
+    b->filas[t->prioridade].ultima->proxima = t;
+  else
+    b->filas[t->prioridade].primeira = t;
+  b->filas[t->prioridade].ultima = t;
+  iniciar_proximo(b);
+  critical_section_exit(&b->trava);
+}
+
+// Dorme até a transação terminar. A IRQ da porta acorda o núcleo; o
+// timeout do WFE garante a vigia do barramento se ela não vier.
+barramento_status_t barramento_aguardar(barramento_t *b, barramento_transacao_t *t)
+{
+  while (t->status == BARRAMENTO_PENDENTE)
+  {
+    barramento_vigiar(b);
+    best_effort_wfe_or_timeout(make_timeout_time_us(1000));
+  }
+  return t->status;
+}
+
+// Fim do bloco em andamento, chamado pela porta (em geral na IRQ)
+void barramento_concluir(barramento_t *b, barramento_status_t status)
+{
+  critical_section_enter_blocking(&b->trava);
+  barramento_transacao_t *t = b->ativa, *fim = NULL;
+  if (t)
+  {
+    b->ativa = NULL;
+    if (status == BARRAMENTO_OK)
+    {
+      t->enviados += b->bloco.n;
+      t->tentativas = 0;
+    }
+    if (status != BARRAMENTO_OK || t->enviados == t->n_escrita)
+    {
+      encerrar(b, t, status);
+      fim = t;
+    }
+    iniciar_proximo(b);
+  }
+  critical_section_exit(&b->trava);
+
+  if (fim && fim->concluida)
+    fim->concluida(fim);
+}
+
+// Bloco sem fim depois de BARRAMENTO_TIMEOUT_US: um escravo prendeu SDA
+// (reset no meio de uma leitura, ruído) ou o controlador travou. Aborta,
+// libera o barramento com pulsos em SCL e repete o bloco.
+void barramento_vigiar(barramento_t *b)
+{
+  critical_section_enter_blocking(&b->trava);
+  barramento_transacao_t *t = b->ativa;
+  if (!t || b->recuperando || time_us_32() - b->bloco_inicio_us < BARRAMENTO_TIMEOUT_US)
+  {
+    critical_section_exit(&b->trava);
+    return;
+  }
+  b->porta->abortar(b);
+  b->ativa = NULL;
+  b->recuperando = true; // A transação fica na frente da fila, sem novos blocos
+  b->recuperacoes++;
+  critical_section_exit(&b->trava);
+
+  // Os pulsos e o i2c_init levam ~100 us: fora da trava, com as interrupções ligadas
+  bool livre = b->porta->recuperar(b);
+
+  barramento_transacao_t *fim = NULL;
+  critical_section_enter_blocking(&b->trava);
+  b->recuperando = false;
+  if (!livre || ++t->tentativas >= BARRAMENTO_TENTATIVAS)
+  {
+    encerrar(b, t, BARRAMENTO_TRAVADO);
+    fim = t;
+  }
+  iniciar_proximo(b);
+  critical_section_exit(&b->trava);
+
+  if (fim && fim->concluida)
+    fim->concluida(fim);
+}
+
+// Espera o bloco em andamento e segura a fila (troca de clock, repouso).
+// As pausas se acumulam: a fila só anda depois do último barramento_retomar.
+void barramento_pausar(barramento_t *b)
+{
+  critical_section_enter_blocking(&b->trava);
+  b->pausas++;
+  critical_section_exit(&b->trava);
+  while (b->ativa || b->recuperando)
+  {
+    barramento_vigiar(b);
+    best_effort_wfe_or_timeout(make_timeout_time_us(1000));
+  }
+}
+
+void barramento_retomar(barramento_t *b)
+{
+  critical_section_enter_blocking(&b->trava);
+  if (b->pausas)
+    b->pausas--;
+  iniciar_proximo(b);
+  critical_section_exit(&b->trava);
+}
+
+void barramento_relatorio(barramento_t *b)
+{
+  printf("BARRAMENTO %lu blocos, %lu falhas, %lu recuperacoes\n", (unsigned long)b->blocos,
+         (unsigned long)b->falhas, (unsigned long)b->recuperacoes);
+  for (int p = 0; p < BARRAMENTO_NUM_PRIORIDADES; p++)
+  {
+    const barramento_estatisticas_t *e = &b->estatisticas[p];
+    printf("  %-6s %lu transacoes, espera media %lu us, max %lu us, duracao max %lu us\n", nomes[p],
+           (unsigned long)e->transacoes, (unsigned long)(e->transacoes ? e->espera_soma_us / e->transacoes : 0),
+           (unsigned long)e->espera_max_us, (unsigned long)e->duracao_max_us);
+  }
+}
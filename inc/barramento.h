@@ -0,0 +1,126 @@
+#ifndef BARRAMENTO_H
+#define BARRAMENTO_H
+
+#include "pico/stdlib.h"
+#include "pico/critical_section.h"
+#include "hardware/i2c.h"
+
+// Gerenciador do barramento I2C compartilhado (display, RTC, sensores).
+//
+// Cada dispositivo enfileira transações; o gerenciador as divide em blocos
+// de até BARRAMENTO_BLOCO bytes (cada bloco é uma transferência com START e
+// STOP próprios) e, a cada fim de bloco, escolhe a fila de maior prioridade
+// com trabalho. Assim uma leitura curta de sensor espera no máximo um bloco
+// de um quadro do display, e não o quadro inteiro. Dentro de uma prioridade
+// a ordem é FIFO, o que mantém os comandos do display antes dos dados.
+//
+// Para uma prioridade baixa não ficar parada atrás de um fluxo contínuo de
+// transações mais altas, cada fila conta os blocos que passaram na frente
+// dela enquanto esperava. A que chegar a BARRAMENTO_MAX_SEGUIDAS ganha a
+// vez (a mais saltada, se houver mais de uma), mas nunca duas vezes
+// seguidas: entre duas promoções passa um bloco da prioridade mais alta,
+// que assim espera no máximo um bloco.
+//
+// As transferências em si são feitas por uma porta (barramento_i2c.c no
+// RP2040, com DMA e IRQ; um mock no simulador do host), que avisa o fim de
+// cada bloco com barramento_concluir(), em geral na IRQ.
+
+#define BARRAMENTO_BLOCO 128          // Bytes de dados por bloco (sem contar o prefixo)
+#define BARRAMENTO_MAX_LEITURA 16     // Bytes lidos numa transação (FIFO de recepção do RP2040)
+#define BARRAMENTO_MAX_SEGUIDAS 4     // Blocos que passam na frente de uma fila esperando antes da vez dela
+#define BARRAMENTO_TIMEOUT_US 20000   // Bloco parado por mais que isso: barramento travado
+#define BARRAMENTO_TENTATIVAS 3       // Tentativas de um bloco após recuperações, antes de desistir
+
+typedef enum {
+  BARRAMENTO_ALTA,   // Leituras curtas de sensores e do RTC
+  BARRAMENTO_NORMAL,
+  BARRAMENTO_BAIXA,  // Quadros do display
+  BARRAMENTO_NUM_PRIORIDADES
+} barramento_prioridade_t;
+
+typedef enum {
+  BARRAMENTO_PENDENTE, // Na fila ou em andamento
+  BARRAMENTO_OK,
+  BARRAMENTO_NACK,     // Endereço ou dado sem ACK
+  BARRAMENTO_ERRO,     // Leitura incompleta ou abortada pelo controlador
+  BARRAMENTO_TRAVADO   // Sem fim de bloco mesmo após BARRAMENTO_TENTATIVAS recuperações
+} barramento_status_t;
+
+typedef struct barramento_transacao {
+  uint8_t endereco;
+  int16_t prefixo;              // Byte repetido no início de cada bloco (0x40 nos dados do SSD1306); -1 sem
+  const uint8_t *escrita;
+  uint16_t n_escrita;
+  uint8_t *leitura;             // Lidos depois da escrita, com repeated START
+  uint8_t n_leitura;
+  uint8_t prioridade;           // barramento_prioridade_t
+  void (*concluida)(struct barramento_transacao *t); // Chamada na IRQ da porta; pode ser NULL
+  void *contexto;
+
+  // Estado mantido pelo gerenciador
+  volatile uint8_t status;
+  uint16_t enviados;
+  uint8_t tentativas;
+  uint32_t enfileirada_us;
+  struct barramento_transacao *proxima;
+} barramento_transacao_t;
+
+// Uma transferência entregue à porta: START, prefixo e dados escritos,
+// repeated START e leitura (se n_leitura > 0) e STOP
+typedef struct {
+  uint8_t endereco;
+  int16_t prefixo;
+  const uint8_t *dados;
+  uint16_t n;
+  uint8_t *leitura;
+  uint8_t n_leitura;
+} barramento_bloco_t;
+
+typedef struct barramento barramento_t;
+
+typedef struct {
+  void (*iniciar)(barramento_t *b, const barramento_bloco_t *bloco); // Não bloqueia
+  void (*abortar)(barramento_t *b);   // Descarta o bloco em andamento (sem chamar barramento_concluir)
+  bool (*recuperar)(barramento_t *b); // Pulsos em SCL até o escravo soltar SDA; true se o barramento ficou livre
+} barramento_porta_t;
+
+typedef struct {
+  uint32_t transacoes;
+  uint32_t espera_max_us;   // Da entrada na fila ao primeiro bloco
+  uint32_t duracao_max_us;  // Da entrada na fila ao fim
+  uint64_t espera_soma_us;
+} barramento_estatisticas_t;
+
+struct barramento {
+  const barramento_porta_t *porta;
+  void *ctx; // Estado da porta
+
+  struct {
+    barramento_transacao_t *primeira, *ultima;
+  } filas[BARRAMENTO_NUM_PRIORIDADES];
+  barramento_transacao_t *volatile ativa; // Dona do bloco em andamento
+  barramento_bloco_t bloco;
+  uint32_t bloco_inicio_us;
+  uint8_t saltos[BARRAMENTO_NUM_PRIORIDADES]; // Blocos que passaram na frente de cada fila esperando
+  bool promoveu;  // O último bloco foi de uma fila promovida
+  uint8_t pausas; // barramento_pausar sem o barramento_retomar correspondente
+  volatile bool recuperando; // Pulsos em SCL fora da trava: a fila não anda
+  critical_section_t trava;
+
+  barramento_estatisticas_t estatisticas[BARRAMENTO_NUM_PRIORIDADES];
+  uint32_t blocos, falhas, recuperacoes;
+};
+
+void barramento_init(barramento_t *b, const barramento_porta_t *porta, void *ctx);
+void barramento_enviar(barramento_t *b, barramento_transacao_t *t);
+barramento_status_t barramento_aguardar(barramento_t *b, barramento_transacao_t *t);
+void barramento_concluir(barramento_t *b, barramento_status_t status);
+void barramento_vigiar(barramento_t *b);
+void barramento_pausar(barramento_t *b);
+void barramento_retomar(barramento_t *b);
+void barramento_relatorio(barramento_t *b);
+
+// Porta do RP2040 (barramento_i2c.c): configura o I2C, os pinos, o DMA e a IRQ
+void barramento_i2c_init(barramento_t *b, i2c_inst_t *i2c, uint sda, uint scl, uint baudrate);
+
+#endif
@@ -0,0 +1,166 @@
+#include "barramento.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/gpio.h"
+
+// Porta do barramento no controlador I2C do RP2040. Cada bloco vira uma
+// sequência de palavras de IC_DATA_CMD (byte, bit de leitura, RESTART e
+// STOP) que o DMA entrega à FIFO no ritmo do DREQ; a IRQ de STOP_DET
+// marca o fim e TX_ABRT o NACK. O DMA escreve 16 bits: com escritas de
+// 8 bits o barramento replicaria o byte nos bits de controle.
+
+#define MEIO_PERIODO_SCL_US 5 // Recuperação a 100 kHz
+
+typedef struct {
+  i2c_inst_t *i2c;
+  uint sda, scl, baudrate;
+  int dma_chan;
+  barramento_status_t status; // NACK visto antes do STOP
+  uint8_t *leitura;
+  uint8_t n_leitura;
+  uint16_t palavras[1 + BARRAMENTO_BLOCO + BARRAMENTO_MAX_LEITURA];
+} porta_i2c_t;
+
+static porta_i2c_t portas[NUM_I2CS];
+static barramento_t *barramentos[NUM_I2CS];
+
+static void habilitar_irq(porta_i2c_t *p)
+{
+  i2c_get_hw(p->i2c)->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+}
+
+static void iniciar(barramento_t *b, const barramento_bloco_t *bloco)
+{
+  porta_i2c_t *p = b->ctx;
+  i2c_hw_t *hw = i2c_get_hw(p->i2c);
+  uint n = 0;
+  if (bloco->prefixo >= 0)
+    p->palavras[n++] = (uint8_t)bloco->prefixo;
+  for (uint i = 0; i < bloco->n; i++)
+    p->palavras[n++] = bloco->dados[i];
+  bool escreveu = n > 0; // A leitura depois de uma escrita começa com repeated START
+  for (uint i = 0; i < bloco->n_leitura; i++)
+    p->palavras[n++] = I2C_IC_DATA_CMD_CMD_BITS | (i == 0 && escreveu ? I2C_IC_DATA_CMD_RESTART_BITS : 0);
+  p->palavras[n - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+  p->status = BARRAMENTO_OK;
+  p->leitura = bloco->leitura;
+  p->n_leitura = bloco->n_leitura;
+
+  // O endereço só pode mudar com o controlador desabilitado
+  hw->enable = 0;
+  hw->tar = bloco->endereco;
+  hw->enable = 1;
+  dma_channel_transfer_from_buffer_now(p->dma_chan, p->palavras, n);
+}
+
+static void tratar_irq(uint indice)
+{
+  barramento_t *b = barramentos[indice];
+  porta_i2c_t *p = b->ctx;
+  i2c_hw_t *hw = i2c_get_hw(p->i2c);
+  uint32_t intr = hw->intr_stat;
+
+  if (intr & I2C_IC_INTR_STAT_R_TX_ABRT_BITS)
+  {
+    // O controlador descarta a FIFO e gera o STOP; o DMA não pode continuar
+    dma_channel_abort(p->dma_chan);
+    p->status = hw->tx_abrt_source & (I2C_IC_TX_ABRT_SOURCE_ABRT_7B_ADDR_NOACK_BITS | I2C_IC_TX_ABRT_SOURCE_ABRT_TXDATA_NOACK_BITS)
+                    ? BARRAMENTO_NACK
+                    : BARRAMENTO_ERRO;
+    (void)hw->clr_tx_abrt;
+  }
+  if (intr & I2C_IC_INTR_STAT_R_STOP_DET_BITS)
+  {
+    (void)hw->clr_stop_det;
+    for (uint i = 0; i < p->n_leitura && p->status == BARRAMENTO_OK; i++)
+    {
+      if (!hw->rxflr)
+        p->status = BARRAMENTO_ERRO; // STOP antes de todos os bytes
+      else
+        p->leitura[i] = (uint8_t)hw->data_cmd;
+    }
+    barramento_concluir(b, p->status);
+  }
+}
+
+static void irq_i2c0() { tratar_irq(0); }
+static void irq_i2c1() { tratar_irq(1); }
+
+static void abortar(barramento_t *b)
+{
+  porta_i2c_t *p = b->ctx;
+  i2c_get_hw(p->i2c)->intr_mask = 0; // O STOP do aborto não deve chegar ao gerenciador
+  dma_channel_abort(p->dma_chan);
+}
+
+// Libera um escravo que prendeu SDA no meio de um byte: até 9 pulsos em
+// SCL (ele termina o byte e solta a linha) e um STOP. Os pinos ficam em
+// dreno aberto: nível baixo com o pino como saída, alto pelo pull-up.
+static bool recuperar(barramento_t *b)
+{
+  porta_i2c_t *p = b->ctx;
+  gpio_set_function(p->sda, GPIO_FUNC_SIO);
+  gpio_set_function(p->scl, GPIO_FUNC_SIO);
+  gpio_put(p->sda, 0);
+  gpio_put(p->scl, 0);
+  gpio_set_dir(p->sda, GPIO_IN);
+  gpio_set_dir(p->scl, GPIO_IN);
+  busy_wait_us_32(MEIO_PERIODO_SCL_US);
+
+  for (int i = 0; i < 9 && !gpio_get(p->sda); i++)
+  {
+    gpio_set_dir(p->scl, GPIO_OUT);
+    busy_wait_us_32(MEIO_PERIODO_SCL_US);
+    gpio_set_dir(p->scl, GPIO_IN);
+    busy_wait_us_32(MEIO_PERIODO_SCL_US);
+  }
+
+  // STOP: SDA sobe com SCL em nível alto
+  gpio_set_dir(p->scl, GPIO_OUT);
+  gpio_set_dir(p->sda, GPIO_OUT);
+  busy_wait_us_32(MEIO_PERIODO_SCL_US);
+  gpio_set_dir(p->scl, GPIO_IN);
+  busy_wait_us_32(MEIO_PERIODO_SCL_US);
+  gpio_set_dir(p->sda, GPIO_IN);
+  busy_wait_us_32(MEIO_PERIODO_SCL_US);
+  bool livre = gpio_get(p->sda) && gpio_get(p->scl);
+
+  // i2c_init reinicia o bloco e volta a habilitar o DMA
+  gpio_set_function(p->sda, GPIO_FUNC_I2C);
+  gpio_set_function(p->scl, GPIO_FUNC_I2C);
+  i2c_init(p->i2c, p->baudrate);
+  habilitar_irq(p);
+  return livre;
+}
+
+static const barramento_porta_t porta_i2c = {iniciar, abortar, recuperar};
+
+void barramento_i2c_init(barramento_t *b, i2c_inst_t *i2c, uint sda, uint scl, uint baudrate)
+{
+  uint indice = i2c_hw_index(i2c);
+  porta_i2c_t *p = &portas[indice];
+  p->i2c = i2c;
+  p->sda = sda;
+  p->scl = scl;
+  p->baudrate = baudrate;
+
+  i2c_init(i2c, baudrate);
+  gpio_set_function(sda, GPIO_FUNC_I2C);
+  gpio_set_function(scl, GPIO_FUNC_I2C);
+  gpio_pull_up(sda);
+  gpio_pull_up(scl);
+
+  p->dma_chan = dma_claim_unused_channel(true);
+  dma_channel_config c = dma_channel_get_default_config(p->dma_chan);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, i2c_get_dreq(i2c, true));
+  dma_channel_configure(p->dma_chan, &c, &i2c_get_hw(i2c)->data_cmd, p->palavras, 0, false);
+
+  barramento_init(b, &porta_i2c, p);
+  barramentos[indice] = b;
+  habilitar_irq(p);
+  irq_set_exclusive_handler(I2C0_IRQ + indice, indice ? irq_i2c1 : irq_i2c0);
+  irq_set_enabled(I2C0_IRQ + indice, true);
+}
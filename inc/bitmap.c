@@ -0,0 +1,129 @@
+#include "bitmap.h"
+#include "trace.h"
+#include <stdio.h>
+
+#define BITMAP_ESPACO_DIGITOS 1 // Colunas entre os dígitos de bitmap_numero
+#define BITMAP_REPETICOES 100   // Desenhos de cada bitmap por medida no relatório
+
+_Static_assert(BITMAP_DIGITO_9 == BITMAP_DIGITO_0 + 9, "os digitos precisam estar em sequencia em assets/digitos.txt");
+
+// Estado da descompressão: quanto falta do trecho atual (literal ou
+// repetição). Bytes crus são um literal que não acaba.
+typedef struct {
+  const uint8_t *p;
+  uint16_t restantes;
+  bool repete;
+  uint8_t valor;
+} leitor_t;
+
+static inline uint8_t ler(leitor_t *l)
+{
+  if (!l->restantes)
+  {
+    uint8_t c = *l->p++;
+    l->repete = c & 0x80;
+    l->restantes = (c & 0x7F) + (l->repete ? 2 : 1);
+    if (l->repete)
+      l->valor = *l->p++;
+  }
+  l->restantes--;
+  return l->repete ? l->valor : *l->p++;
+}
+
+// Os bytes vêm página por página do bitmap; cada um cai em uma coluna do
+// buffer, dividido entre duas páginas do display quando y não é múltiplo
+// de 8. Só os pixels do retângulo do bitmap são trocados.
+static void desenhar(ssd1306_t *ssd, const bitmap_t *b, uint8_t x, uint8_t y)
+{
+  leitor_t l = {b->dados, b->rle ? 0 : UINT16_MAX, false, 0};
+  uint8_t paginas = (b->altura + 7) >> 3;
+  uint8_t desloc = y & 7;
+
+  for (uint8_t p = 0; p < paginas; p++)
+  {
+    uint8_t resto = b->altura - (p << 3); // A última página pode estar incompleta
+    uint8_t mascara = resto >= 8 ? 0xFF : (uint8_t)((1u << resto) - 1);
+    uint16_t m = (uint16_t)mascara << desloc;
+    uint8_t destino = (y >> 3) + p;
+
+    for (uint16_t cx = x; cx < x + b->largura; cx++)
+    {
+      uint16_t bits = (uint16_t)(ler(&l) & mascara) << desloc;
+      if (cx >= ssd->width)
+        continue;
+      uint8_t *coluna = &ssd->ram_buffer[(cx << 3) + 1];
+      if (destino < ssd->pages)
+        coluna[destino] = (coluna[destino] & (uint8_t)~m) | (uint8_t)bits;
+      if (desloc && destino + 1 < ssd->pages)
+        coluna[destino + 1] = (coluna[destino + 1] & (uint8_t)~(m >> 8)) | (uint8_t)(bits >> 8);
+    }
+  }
+}
+
+void bitmap_desenhar(ssd1306_t *ssd, bitmap_id_t id, uint8_t x, uint8_t y)
+{
+  if (id >= BITMAP_NUM)
+    return;
+  TRACE_BEGIN(TRACE_BITMAP);
+  desenhar(ssd, &bitmaps[id], x, y);
+  TRACE_END(TRACE_BITMAP);
+}
+
+// Escreve um número (negativos viram 0) com os dígitos grandes a partir de
+// (x, y); retorna a largura ocupada
+uint8_t bitmap_numero(ssd1306_t *ssd, int valor, uint8_t x, uint8_t y)
+{
+  char digitos[12];
+  int n = snprintf(digitos, sizeof(digitos), "%d", valor < 0 ? 0 : valor);
+  uint16_t cx = x;
+
+  TRACE_BEGIN(TRACE_BITMAP);
+  for (int i = 0; i < n && cx < ssd->width; i++)
+  {
+    const bitmap_t *b = &bitmaps[BITMAP_DIGITO_0 + digitos[i] - '0'];
+    desenhar(ssd, b, (uint8_t)cx, y);
+    cx += b->largura + BITMAP_ESPACO_DIGITOS;
+  }
+  TRACE_END(TRACE_BITMAP);
+  return cx > x ? (uint8_t)(cx - x - BITMAP_ESPACO_DIGITOS) : 0;
+}
+
+// Microssegundos de 100 desenhos em centésimos de us por desenho
+#define CENTESIMOS(us) (unsigned long)((us) * 100 / BITMAP_REPETICOES / 100), (unsigned long)((us) * 100 / BITMAP_REPETICOES % 100)
+
+// Flash ocupada pelos bitmaps e tempo de desenho, medido num buffer de
+// rascunho do tamanho do maior bitmap (o display não é tocado), com y
+// alinhado à página e deslocado
+void bitmap_relatorio()
+{
+  uint8_t buffer[1 + BITMAP_LARGURA_MAX * 8];
+  ssd1306_t rascunho = {.width = BITMAP_LARGURA_MAX, .height = HEIGHT, .pages = HEIGHT / 8,
+                        .ram_buffer = buffer, .bufsize = sizeof(buffer)};
+  uint32_t total_bytes = 0, total_us = 0;
+
+  printf("BITMAPS %d, %d bytes crus, %d bytes de dados + %u da tabela na flash, leitor de %u bytes na pilha\n",
+         BITMAP_NUM, BITMAP_BYTES_BRUTOS, BITMAP_BYTES_FLASH, (unsigned)sizeof(bitmaps), (unsigned)sizeof(leitor_t));
+  for (int i = 0; i < BITMAP_NUM; i++)
+  {
+    const bitmap_t *b = &bitmaps[i];
+    uint32_t inicio = time_us_32();
+    for (int r = 0; r < BITMAP_REPETICOES; r++)
+      desenhar(&rascunho, b, 0, 0);
+    uint32_t alinhado = time_us_32() - inicio;
+    inicio = time_us_32();
+    for (int r = 0; r < BITMAP_REPETICOES; r++)
+      desenhar(&rascunho, b, 0, 3);
+    uint32_t deslocado = time_us_32() - inicio;
+
+    uint32_t bruto = b->largura * ((b->altura + 7) >> 3);
+    total_bytes += 2 * BITMAP_REPETICOES * bruto;
+    total_us += alinhado + deslocado;
+    printf("  %-9s %2ux%-2u %3lu -> %3u bytes %-4s %lu.%02lu us alinhado, %lu.%02lu us deslocado\n", b->nome,
+           b->largura, b->altura, (unsigned long)bruto, b->tamanho, b->rle ? "rle" : "cru", CENTESIMOS(alinhado),
+           CENTESIMOS(deslocado));
+  }
+  if (total_us)
+    printf("  vazao %lu bytes/ms\n", (unsigned long)(total_bytes * 1000ull / total_us));
+  else
+    printf("  vazao sem medida (tempo de CPU nao simulado)\n");
+}
@@ -0,0 +1,27 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include "ssd1306.h"
+#include "bitmaps_gerados.h"
+
+// Ícones e dígitos grandes gerados de assets/ por tools/gerar_bitmaps.py
+// (passo do build). Os dados ficam em const, na flash, empacotados em
+// páginas como no SSD1306 e, quando compensa, comprimidos em RLE. O
+// desenho descomprime byte a byte direto no buffer do display: o bitmap
+// nunca existe inteiro na RAM, só o estado do leitor, na pilha.
+
+typedef struct {
+  const char *nome;
+  uint8_t largura, altura;
+  bool rle;          // false: bytes crus
+  uint16_t tamanho;  // Bytes na flash
+  const uint8_t *dados;
+} bitmap_t;
+
+extern const bitmap_t bitmaps[BITMAP_NUM];
+
+void bitmap_desenhar(ssd1306_t *ssd, bitmap_id_t id, uint8_t x, uint8_t y);
+uint8_t bitmap_numero(ssd1306_t *ssd, int valor, uint8_t x, uint8_t y);
+void bitmap_relatorio();
+
+#endif
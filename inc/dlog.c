@@ -0,0 +1,165 @@
+#include "dlog.h"
+#include "trace.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#include "hardware/sync.h"
+#include "hardware/structs/scb.h"
+#include <stdio.h>
+
+#if !DLOG_BINARIO
+#define DLOG_FMT(id, fmt) fmt,
+static const char *const formatos[] = {DLOG_FORMATOS(DLOG_FMT)};
+#undef DLOG_FMT
+#endif
+
+static dlog_registro_t fila[DLOG_TAM_FILA];
+static volatile uint32_t cabeca = 0;   // Escrito apenas pelos produtores
+static volatile uint32_t cauda = 0;    // Escrito apenas pelo consumidor
+static volatile uint32_t perdidos = 0; // Registros descartados com a fila cheia
+static uint32_t perdidos_relatados = 0;
+static uint16_t seq = 0;
+static void (*volatile tarefa_extra)() = NULL; // Outra tarefa periódica do núcleo 1
+static volatile bool estacionar = false;        // Núcleo 1 parado em WFE (repouso)
+
+// Laço de drenagem do núcleo 1: formata/transmite fora do loop de controle
+static void dlog_nucleo1()
+{
+  flash_safe_execute_core_init(); // Permite que o núcleo 0 grave na flash (histórico)
+  while (true)
+  {
+    if (estacionar)
+    {
+      // SLEEPDEEP deste núcleo: com o núcleo 0 também dormindo, os clocks
+      // fora do SLEEP_EN param. A interrupção do lockout da flash ainda acorda
+      scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+      while (estacionar)
+        __wfe();
+      scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+    }
+    dlog_drenar();
+    void (*t)() = tarefa_extra;
+    if (t)
+      t();
+    sleep_ms(DLOG_PERIODO_MS);
+  }
+}
+
+void dlog_init()
+{
+  multicore_launch_core1(dlog_nucleo1);
+}
+
+// Registra uma tarefa para rodar no núcleo 1 a cada DLOG_PERIODO_MS, após a drenagem
+void dlog_tarefa(void (*tarefa)())
+{
+  tarefa_extra = tarefa;
+}
+
+// Repouso: o núcleo 1 termina o ciclo em andamento e para em WFE, sem
+// drenar nem rodar a tarefa periódica, até dlog_retomar()
+void dlog_estacionar()
+{
+  estacionar = true;
+}
+
+void dlog_retomar()
+{
+  estacionar = false;
+  __sev();
+}
+
+bool dlog_estacionado()
+{
+  return estacionar;
+}
+
+void dlog_registrar(dlog_id_t id, uint8_t nargs, int32_t a, int32_t b)
+{
+  uint32_t tempo = time_us_32();
+
+  // Só os produtores do núcleo 0 disputam a cabeça; mascarar as interrupções
+  // por alguns ciclos basta, e o consumidor nunca espera por eles
+  uint32_t status = save_and_disable_interrupts();
+  uint32_t h = cabeca;
+  if (h - cauda >= DLOG_TAM_FILA)
+  {
+    perdidos++;
+    restore_interrupts(status);
+    return;
+  }
+
+  dlog_registro_t *r = &fila[h & (DLOG_TAM_FILA - 1)];
+  r->tempo_us = tempo;
+  r->id = id;
+  r->nargs = nargs;
+  r->seq = seq++;
+  r->args[0] = a;
+  r->args[1] = b;
+  __dmb(); // O registro fica visível antes da nova cabeça
+  cabeca = h + 1;
+  restore_interrupts(status);
+}
+
+#if DLOG_BINARIO
+// Envia um registro no formato binário: sincronismo, registro e soma de verificação
+static void enviar_binario(const dlog_registro_t *r)
+{
+  const uint8_t *bytes = (const uint8_t *)r;
+  uint8_t soma = 0;
+  putchar_raw(DLOG_SINC);
+  for (size_t i = 0; i < sizeof(*r); i++)
+  {
+    putchar_raw(bytes[i]);
+    soma += bytes[i];
+  }
+  putchar_raw(soma);
+}
+#endif
+
+static void emitir(const dlog_registro_t *r)
+{
+#if DLOG_BINARIO
+  enviar_binario(r);
+#else
+  if (r->id < DLOG_NUM_FORMATOS)
+  {
+    printf(formatos[r->id], r->args[0], r->args[1]);
+    printf("\n");
+  }
+#endif
+}
+
+uint dlog_drenar()
+{
+  uint n = 0;
+  uint32_t t = cauda;
+
+  if (t == cabeca && perdidos == perdidos_relatados)
+    return 0;
+  TRACE_BEGIN(TRACE_DLOG_DRENAR);
+
+  while (t != cabeca)
+  {
+    __dmb(); // Lê o registro só depois de observar a cabeça
+    dlog_registro_t r = fila[t & (DLOG_TAM_FILA - 1)];
+    cauda = ++t;
+    emitir(&r);
+    n++;
+  }
+
+  // Relata os descartes como um registro comum
+  uint32_t p = perdidos;
+  if (p != perdidos_relatados)
+  {
+    dlog_registro_t r = {time_us_32(), DLOG_PERDIDOS, 1, 0, {(int32_t)(p - perdidos_relatados), 0}};
+    perdidos_relatados = p;
+    emitir(&r);
+  }
+  TRACE_END(TRACE_DLOG_DRENAR);
+  return n;
+}
+
+uint32_t dlog_perdidos()
+{
+  return perdidos;
+}
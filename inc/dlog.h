@@ -0,0 +1,36 @@
+#ifndef DLOG_H
+#define DLOG_H
+
+#include "pico/stdlib.h"
+#include "dlog_fmt.h"
+
+#define DLOG_MAX_ARGS 2      // Argumentos inteiros por registro
+#define DLOG_TAM_FILA 64     // Registros na fila (potência de 2)
+#define DLOG_PERIODO_MS 20   // Intervalo de drenagem no núcleo 1
+#define DLOG_SINC 0xD5       // Byte de sincronismo de cada registro no modo binário
+
+// Registro compacto: o formato só é aplicado na drenagem
+typedef struct {
+  uint32_t tempo_us;
+  uint8_t id;
+  uint8_t nargs;
+  uint16_t seq;
+  int32_t args[DLOG_MAX_ARGS];
+} dlog_registro_t;
+
+// Produtores rodam no núcleo 0 (loop principal e interrupções);
+// o núcleo 1 é o único consumidor.
+#define DLOG0(id) dlog_registrar((id), 0, 0, 0)
+#define DLOG1(id, a) dlog_registrar((id), 1, (a), 0)
+#define DLOG2(id, a, b) dlog_registrar((id), 2, (a), (b))
+
+void dlog_init();
+void dlog_tarefa(void (*tarefa)());
+void dlog_estacionar();
+void dlog_retomar();
+bool dlog_estacionado();
+void dlog_registrar(dlog_id_t id, uint8_t nargs, int32_t a, int32_t b);
+uint dlog_drenar();
+uint32_t dlog_perdidos();
+
+#endif
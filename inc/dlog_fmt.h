@@ -0,0 +1,29 @@
+#ifndef DLOG_FMT_H
+#define DLOG_FMT_H
+
+// Tabela de formatos do log diferido: X(id, "formato").
+// Os ids são a posição na tabela e vão no registro binário; novas
+// mensagens entram sempre no final. O tools/dlog_decode.py lê este
+// arquivo para converter o fluxo binário de volta em texto.
+#define DLOG_FORMATOS(X)                                        \
+  X(DLOG_PERDIDOS, "[dlog] %d registros perdidos")              \
+  X(DLOG_RACAO, "racao: %d")                                    \
+  X(DLOG_AGUA, "agua: %d")                                      \
+  X(DLOG_ENCHER, "Encher selecionado")                          \
+  X(DLOG_CHEIOS, "Racao/agua cheios")                           \
+  X(DLOG_SAIR, "Sair selecionado")                              \
+  X(DLOG_MODO_AUTO, "Modo alterado para: AUTO")                 \
+  X(DLOG_MODO_MANUAL, "Modo alterado para: MANUAL")             \
+  X(DLOG_DEFINIR_TEMPO, "Defina o tempo do modo automatico...") \
+  X(DLOG_RACAO_INSUFICIENTE, "Racao insuficiente")              \
+  X(DLOG_AGUA_INSUFICIENTE, "Agua insuficiente")                \
+  X(DLOG_CONFIG_REMOTA, "Configuracao remota: %d campos")
+
+#define DLOG_ID(id, fmt) id,
+typedef enum {
+  DLOG_FORMATOS(DLOG_ID)
+  DLOG_NUM_FORMATOS
+} dlog_id_t;
+#undef DLOG_ID
+
+#endif
@@ -0,0 +1,143 @@
+#include "entrada.h"
+#include "hardware/adc.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Fila circular: os contadores só crescem e o índice é o resto pelo tamanho
+// (potência de 2), então ocupados = escrito - lido mesmo depois da volta
+static uint8_t gravacao[ENTRADA_TAM_GRAVACAO];
+static size_t escrito = 0, lido = 0;
+static uint32_t perdidos = 0;   // Registros descartados com a gravação cheia
+static uint64_t ultimo_us = 0;  // Tempo do último registro gravado (64 bits: horas sem entrada no modo automático)
+static uint16_t ultimo_adc[5] = {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF};
+static uint32_t niveis = 0xFFFFFFFF; // Último nível gravado de cada GPIO
+static volatile uint64_t atividade_us = 0; // Última borda ou joystick fora do centro
+
+static void gravar(entrada_tipo_t tipo, uint canal, uint16_t valor)
+{
+  uint8_t reg[1 + 10 + 2]; // Tipo, varint de até 64 bits e valor do ADC
+  size_t n = 0;
+
+  // Chamada pelo loop e pela interrupção de GPIO
+  uint32_t status = save_and_disable_interrupts();
+  uint64_t agora = time_us_64();
+  uint64_t dt = agora - ultimo_us;
+
+  reg[n++] = (tipo << 6) | (canal & 0x3F);
+  do
+  {
+    reg[n++] = (dt & 0x7F) | (dt > 0x7F ? 0x80 : 0);
+    dt >>= 7;
+  } while (dt);
+  if (tipo == ENTRADA_ADC)
+  {
+    reg[n++] = valor & 0xFF;
+    reg[n++] = valor >> 8;
+  }
+
+  if (escrito - lido + n > ENTRADA_TAM_GRAVACAO)
+  {
+    perdidos++;
+  }
+  else
+  {
+    for (size_t i = 0; i < n; i++)
+      gravacao[escrito++ % ENTRADA_TAM_GRAVACAO] = reg[i];
+    ultimo_us = agora;
+  }
+  restore_interrupts(status);
+}
+
+uint16_t entrada_adc(uint canal)
+{
+  adc_select_input(canal);
+  uint16_t valor = adc_read();
+
+  if (canal < 5 && abs((int)valor - (int)ultimo_adc[canal]) >= ENTRADA_ADC_LIMIAR)
+  {
+    ultimo_adc[canal] = valor;
+    gravar(ENTRADA_ADC, canal, valor);
+  }
+  if (abs((int)valor - ENTRADA_ADC_CENTRO) > ENTRADA_ADC_ATIVIDADE)
+    atividade_us = time_us_64();
+  return valor;
+}
+
+static void gravar_nivel(uint pino, bool nivel)
+{
+  if (((niveis >> pino) & 1) != nivel)
+  {
+    niveis ^= 1u << pino;
+    gravar(nivel ? ENTRADA_GPIO_ALTO : ENTRADA_GPIO_BAIXO, pino, 0);
+    atividade_us = time_us_64();
+  }
+}
+
+bool entrada_gpio(uint pino)
+{
+  bool nivel = gpio_get(pino);
+  gravar_nivel(pino, nivel);
+  return nivel;
+}
+
+// Chamada pela interrupção de GPIO com as bordas detectadas
+void entrada_borda(uint pino, uint32_t eventos)
+{
+  if (eventos & GPIO_IRQ_EDGE_FALL)
+    gravar_nivel(pino, false);
+  if (eventos & GPIO_IRQ_EDGE_RISE)
+    gravar_nivel(pino, true);
+}
+
+// Copia e remove a gravação acumulada; os tempos continuam relativos ao
+// último registro, então drenagens sucessivas formam um fluxo contínuo.
+// Um consumidor só: a cópia fica fora da trava, porque gravar() não escreve
+// sobre o que ainda não foi lido.
+size_t entrada_drenar(uint8_t *destino, size_t max)
+{
+  uint32_t status = save_and_disable_interrupts();
+  size_t ocupados = escrito - lido;
+  restore_interrupts(status);
+
+  size_t n = ocupados < max ? ocupados : max;
+  size_t inicio = lido % ENTRADA_TAM_GRAVACAO;
+  size_t ate_o_fim = ENTRADA_TAM_GRAVACAO - inicio;
+  size_t primeiro = n < ate_o_fim ? n : ate_o_fim;
+  memcpy(destino, &gravacao[inicio], primeiro);
+  memcpy(destino + primeiro, gravacao, n - primeiro); // O resto depois da volta
+
+  status = save_and_disable_interrupts();
+  lido += n;
+  restore_interrupts(status);
+  return n;
+}
+
+uint32_t entrada_perdidos()
+{
+  return perdidos;
+}
+
+// Tempo (µs desde o boot) do último uso dos botões ou do joystick
+uint64_t entrada_ultima_atividade_us()
+{
+  return atividade_us;
+}
+
+// Exporta a gravação em hexadecimal pela serial (lida por tools/gravar_entradas.py)
+void entrada_exportar()
+{
+  uint8_t bloco[32];
+  size_t n;
+
+  printf("GRAVACAO %lu\n", (unsigned long)perdidos);
+  while ((n = entrada_drenar(bloco, sizeof(bloco))) > 0)
+  {
+    for (size_t i = 0; i < n; i++)
+      printf("%02x", bloco[i]);
+    printf("\n");
+  }
+  printf("GRAVACAO_FIM\n");
+}
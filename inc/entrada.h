@@ -0,0 +1,37 @@
+#ifndef ENTRADA_H
+#define ENTRADA_H
+
+#include "pico/stdlib.h"
+
+// Camada de entrada: todas as leituras de botões e do joystick passam por
+// aqui e são gravadas num registro binário compacto, que pode ser exportado
+// pela serial e reproduzido no simulador do host (host/, modo replay).
+//
+// Formato de cada registro:
+//   byte 0: (tipo << 6) | pino/canal, com tipo 0 = GPIO baixo, 1 = GPIO alto, 2 = ADC
+//   varint: µs desde o registro anterior (desde o boot no primeiro), até 64 bits
+//   ADC:    valor de 12 bits em 2 bytes little-endian
+// Um arquivo de gravação é o cabeçalho "RPL1" seguido dos registros.
+
+#define ENTRADA_TAM_GRAVACAO 4096 // Bytes de gravação em RAM entre exportações (potência de 2)
+#define ENTRADA_ADC_LIMIAR 16     // Variação mínima do ADC para gravar uma nova amostra
+#define ENTRADA_CABECALHO "RPL1"
+#define ENTRADA_ADC_CENTRO 2047   // Joystick solto
+#define ENTRADA_ADC_ATIVIDADE 200 // Desvio do centro que conta como uso (limiar dos menus)
+
+typedef enum {
+  ENTRADA_GPIO_BAIXO = 0,
+  ENTRADA_GPIO_ALTO = 1,
+  ENTRADA_ADC = 2
+} entrada_tipo_t;
+
+uint16_t entrada_adc(uint canal);
+bool entrada_gpio(uint pino);
+void entrada_borda(uint pino, uint32_t eventos);
+
+size_t entrada_drenar(uint8_t *destino, size_t max);
+uint32_t entrada_perdidos();
+uint64_t entrada_ultima_atividade_us();
+void entrada_exportar();
+
+#endif
@@ -0,0 +1,220 @@
+#include "espelho.h"
+#include "protocolo.h"
+#include "pico/critical_section.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TAM_QUADRO(n) (PROTOCOLO_CABECALHO + (n) + 2) // Bytes na serial de um quadro com n de payload
+#define MAX_LITERAL 128
+#define MAX_REPETICAO 65
+#define MAX_PULO 64
+
+static ssd1306_t *display = NULL;
+static critical_section_t trava;        // Protege 'capturado' e 'capturas' entre os núcleos
+static uint8_t capturado[ESPELHO_BYTES]; // Buffer do último envio ao display (núcleo 0)
+static uint32_t capturas = 0;
+static uint8_t espelhado[ESPELHO_BYTES]; // O que o visualizador já tem (núcleo 1)
+
+// Escritos pelo núcleo 0 (pedido do protocolo), lidos pelo núcleo 1
+static volatile uint32_t orcamento = 0; // bytes/s; 0 desligado
+static volatile bool reiniciar = false;
+
+// Estado do núcleo 1
+static uint16_t cursor = 0;
+static uint64_t fichas = 0; // Orçamento acumulado, em bytes * 10^6 (bytes/s vezes us)
+static uint64_t ultimo_us = 0, ligado_us = 0;
+static uint32_t fechado = 0; // Última captura fechada com PROTOCOLO_ESPELHO_QUADRO
+static bool algum_fechado = false;
+static uint8_t seq = 0;
+
+static uint32_t pacotes = 0, quadros = 0, bytes_enviados = 0, captura_max_us = 0;
+
+void espelho_init(ssd1306_t *ssd)
+{
+  display = ssd;
+  critical_section_init(&trava);
+}
+
+// Pedido do visualizador (núcleo 0). Ligar de novo reenvia a tela inteira.
+bool espelho_definir(uint32_t bytes_por_s)
+{
+  if (bytes_por_s && (bytes_por_s < ESPELHO_ORCAMENTO_MIN || bytes_por_s > ESPELHO_ORCAMENTO_MAX))
+    return false;
+  // O núcleo 1 lê orcamento antes de reiniciar: com o pedido de reinício
+  // gravado primeiro, ele nunca vê o orçamento novo com o estado antigo
+  if (bytes_por_s)
+    reiniciar = true;
+  __dmb();
+  orcamento = bytes_por_s;
+  if (bytes_por_s && display)
+    espelho_capturar(display); // O que está na tela agora, sem esperar o próximo envio
+  return true;
+}
+
+// Chamada pelo driver depois de cada envio (núcleo 0). O núcleo 1 só
+// segura a trava para montar um pacote, então a espera é curta.
+void espelho_capturar(ssd1306_t *ssd)
+{
+  if (!orcamento)
+    return;
+  uint32_t inicio = time_us_32();
+  critical_section_enter_blocking(&trava);
+  memcpy(capturado, ssd->ram_buffer + 1, ESPELHO_BYTES);
+  capturas++;
+  critical_section_exit(&trava);
+  uint32_t duracao = time_us_32() - inicio;
+  if (duracao > captura_max_us)
+    captura_max_us = duracao;
+}
+
+static bool repete(uint16_t i)
+{
+  return i + 2 < ESPELHO_BYTES && capturado[i] == capturado[i + 1] && capturado[i] == capturado[i + 2];
+}
+
+// Monta num payload as diferenças a partir do cursor, até o fim do buffer
+// ou do payload, e passa para 'espelhado' o que entrou. Retorna o tamanho
+// do payload, 0 se o visualizador já tem tudo. Chamada com a trava.
+static size_t montar(uint8_t *p)
+{
+  // Primeira diferença, dando no máximo uma volta
+  uint16_t i = cursor, vistos = 0;
+  while (vistos < ESPELHO_BYTES && capturado[i] == espelhado[i])
+  {
+    i = (i + 1) % ESPELHO_BYTES;
+    vistos++;
+  }
+  if (vistos == ESPELHO_BYTES)
+    return 0;
+
+  p[0] = i;
+  p[1] = i >> 8;
+  size_t n = 2;
+  while (i < ESPELHO_BYTES)
+  {
+    uint16_t iguais = 0;
+    while (i + iguais < ESPELHO_BYTES && capturado[i + iguais] == espelhado[i + iguais])
+      iguais++;
+    if (i + iguais == ESPELHO_BYTES)
+    {
+      i = ESPELHO_BYTES; // O resto já está igual
+      break;
+    }
+    if (iguais)
+    {
+      if (n + 1 > PROTOCOLO_MAX_PAYLOAD)
+        break;
+      uint16_t k = iguais > MAX_PULO ? MAX_PULO : iguais;
+      p[n++] = 0xC0 | (k - 1);
+      i += k;
+      continue;
+    }
+
+    // Repetição de um valor (pode cobrir bytes que o visualizador já tem)
+    uint8_t v = capturado[i];
+    uint16_t rep = 1;
+    while (i + rep < ESPELHO_BYTES && rep < MAX_REPETICAO && capturado[i + rep] == v)
+      rep++;
+    if (rep >= 3)
+    {
+      if (n + 2 > PROTOCOLO_MAX_PAYLOAD)
+        break;
+      p[n++] = 0x80 | (rep - 2);
+      p[n++] = v;
+      memset(&espelhado[i], v, rep);
+      i += rep;
+      continue;
+    }
+
+    // Literal até um byte igual, o início de uma repetição ou o fim do payload
+    if (n + 2 > PROTOCOLO_MAX_PAYLOAD)
+      break;
+    size_t cabecalho = n++;
+    uint16_t len = 0;
+    while (i + len < ESPELHO_BYTES && n < PROTOCOLO_MAX_PAYLOAD && len < MAX_LITERAL &&
+           capturado[i + len] != espelhado[i + len] && !(len && repete(i + len)))
+      p[n++] = capturado[i + len++];
+    p[cabecalho] = len - 1;
+    memcpy(&espelhado[i], &capturado[i], len);
+    i += len;
+  }
+  cursor = i % ESPELHO_BYTES;
+  return n;
+}
+
+// Fecha a captura: o visualizador confere o hash antes de mostrar o quadro
+static void fechar(uint32_t captura)
+{
+  uint32_t h = 2166136261u; // FNV-1a, o mesmo do --quadros do simulador
+  for (size_t i = 0; i < ESPELHO_BYTES; i++)
+    h = (h ^ espelhado[i]) * 16777619u;
+  uint8_t p[8] = {captura, captura >> 8, captura >> 16, captura >> 24, h, h >> 8, h >> 16, h >> 24};
+  protocolo_enviar(PROTOCOLO_ESPELHO_QUADRO, seq++, p, sizeof(p));
+  bytes_enviados += TAM_QUADRO(sizeof(p));
+  fechado = captura;
+  algum_fechado = true;
+  quadros++;
+}
+
+// Chamada a cada ciclo do núcleo 1: envia pacotes enquanto houver
+// diferenças e orçamento para um quadro do protocolo inteiro
+void espelho_tarefa()
+{
+  uint32_t bytes_s = orcamento;
+  if (!bytes_s)
+    return;
+
+  uint64_t agora = time_us_64();
+  if (reiniciar)
+  {
+    reiniciar = false;
+    memset(espelhado, 0, sizeof(espelhado)); // O visualizador começa com a tela apagada
+    cursor = 0;
+    fichas = 0;
+    ultimo_us = ligado_us = agora;
+    algum_fechado = false;
+    pacotes = quadros = bytes_enviados = 0;
+  }
+
+  // Sem rajadas além de ESPELHO_RAJADA_MS de orçamento (ou um quadro, se for maior)
+  const uint64_t quadro_max = TAM_QUADRO(PROTOCOLO_MAX_PAYLOAD) * 1000000ull;
+  uint64_t limite = (uint64_t)bytes_s * ESPELHO_RAJADA_MS * 1000;
+  fichas += (agora - ultimo_us) * bytes_s;
+  ultimo_us = agora;
+  if (fichas > (limite > quadro_max ? limite : quadro_max))
+    fichas = limite > quadro_max ? limite : quadro_max;
+
+  while (fichas >= quadro_max)
+  {
+    uint8_t p[PROTOCOLO_MAX_PAYLOAD];
+    critical_section_enter_blocking(&trava);
+    size_t n = montar(p);
+    uint32_t captura = capturas;
+    critical_section_exit(&trava);
+
+    if (!n)
+    {
+      if (!algum_fechado || captura != fechado)
+      {
+        fechar(captura);
+        fichas -= TAM_QUADRO(8) * 1000000ull;
+      }
+      break;
+    }
+    protocolo_enviar(PROTOCOLO_ESPELHO_DADOS, seq++, p, n);
+    fichas -= TAM_QUADRO(n) * 1000000ull;
+    bytes_enviados += TAM_QUADRO(n);
+    pacotes++;
+  }
+}
+
+void espelho_relatorio()
+{
+  uint32_t bytes_s = orcamento;
+  uint64_t ligado = time_us_64() - ligado_us;
+  printf("ESPELHO %s, orcamento %lu bytes/s\n", bytes_s ? "ligado" : "desligado", (unsigned long)bytes_s);
+  printf("  %lu capturas, %lu quadros, %lu pacotes, %lu bytes (%lu bytes/s), captura max %lu us\n",
+         (unsigned long)capturas, (unsigned long)quadros, (unsigned long)pacotes, (unsigned long)bytes_enviados,
+         (unsigned long)(bytes_s && ligado ? bytes_enviados * 1000000ull / ligado : 0), (unsigned long)captura_max_us);
+}
@@ -0,0 +1,37 @@
+#ifndef ESPELHO_H
+#define ESPELHO_H
+
+#include "ssd1306.h"
+
+// Espelhamento do display pela serial USB, para ver à distância o que o
+// OLED mostra (tools/espelho.py).
+//
+// A cada envio ao display o núcleo 0 só copia o buffer, com a trava (um
+// memcpy de 1 KB). O núcleo 1 compara a cópia com o que o visualizador já
+// tem e manda as diferenças em quadros PROTOCOLO_ESPELHO_DADOS, dentro do
+// orçamento de bytes/s. Quando não sobra diferença, um
+// PROTOCOLO_ESPELHO_QUADRO fecha o quadro com o número da captura e o hash
+// do conteúdo. Capturas que chegam antes disso se juntam: com pouco
+// orçamento o espelho pula quadros, mas nunca atrasa o laço de controle.
+//
+// Payload de DADOS: posição inicial no buffer (uint16, índice x * 8 +
+// página, a ordem do ram_buffer) e uma sequência de trechos:
+//   0x00-0x7F  literal: seguem c + 1 bytes
+//   0x80-0xBF  repetição: o próximo byte vale (c & 0x3F) + 2 vezes
+//   0xC0-0xFF  pula (c & 0x3F) + 1 bytes iguais aos do visualizador
+// Payload de QUADRO: número da captura (uint32) e FNV-1a dos 1024 bytes
+// (uint32), ambos little-endian. O visualizador que divergir do hash
+// (quadro perdido na serial) pede o espelho de novo, o que reenvia tudo.
+
+#define ESPELHO_BYTES (WIDTH * HEIGHT / 8)
+#define ESPELHO_ORCAMENTO_MIN 200    // bytes/s
+#define ESPELHO_ORCAMENTO_MAX 8000   // bytes/s: o stdio também vai à UART, a 115200 baud
+#define ESPELHO_RAJADA_MS 100        // Orçamento acumulado no máximo (ms de envio)
+
+void espelho_init(ssd1306_t *ssd);
+bool espelho_definir(uint32_t bytes_por_s);
+void espelho_capturar(ssd1306_t *ssd);
+void espelho_tarefa();
+void espelho_relatorio();
+
+#endif
@@ -0,0 +1,92 @@
+#include "governador.h"
+#include "trace.h"
+#include "hardware/clocks.h"
+#include "hardware/uart.h"
+#include "pico/multicore.h"
+#include <stdio.h>
+
+static const uint32_t khz[GOVERNADOR_NIVEIS] = {GOVERNADOR_KHZ_OCIOSO, GOVERNADOR_KHZ_NORMAL, GOVERNADOR_KHZ_RAJADA};
+static const char *const nomes[GOVERNADOR_NIVEIS] = {"ocioso", "normal", "rajada"};
+
+static const governador_app_t *app = NULL;
+static governador_nivel_t atual = GOVERNADOR_NORMAL;
+static uint32_t desde_us = 0; // Fim da última transição
+
+// Estatísticas por nível de destino
+static uint64_t permanencia_us[GOVERNADOR_NIVEIS];
+static uint32_t transicoes[GOVERNADOR_NIVEIS];
+static uint64_t soma_us[GOVERNADOR_NIVEIS];
+static uint32_t max_us[GOVERNADOR_NIVEIS];
+
+void governador_init(const governador_app_t *a)
+{
+  app = a;
+  desde_us = time_us_32();
+}
+
+#if GOVERNADOR_ENABLED
+static void mudar_clock(governador_nivel_t nivel)
+{
+  app->antes();
+
+  // O núcleo 1 (log, telemetria) fica parado fora da UART enquanto clk_peri muda;
+  // sem a pausa (núcleo 1 ainda não iniciado) a troca segue do mesmo jeito
+  bool pausou = multicore_lockout_start_timeout_us(GOVERNADOR_LOCKOUT_US);
+#ifdef uart_default
+  uart_tx_wait_blocking(uart_default); // Não corta um byte em transmissão
+#endif
+
+  set_sys_clock_khz(khz[nivel], true); // clk_peri acompanha clk_sys
+
+#ifdef uart_default
+  uart_set_baudrate(uart_default, PICO_DEFAULT_UART_BAUD_RATE);
+#endif
+  app->depois(clock_get_hz(clk_sys));
+
+  if (pausou)
+    multicore_lockout_end_timeout_us(GOVERNADOR_LOCKOUT_US);
+}
+#endif
+
+// Troca o nível do clock e retorna o anterior, para que uma rajada possa restaurá-lo
+governador_nivel_t governador_definir(governador_nivel_t nivel)
+{
+  governador_nivel_t anterior = atual;
+  if (nivel == atual || nivel >= GOVERNADOR_NIVEIS || !app)
+    return anterior;
+
+  TRACE_BEGIN(TRACE_GOVERNADOR);
+  uint32_t inicio = time_us_32();
+#if GOVERNADOR_ENABLED
+  mudar_clock(nivel);
+#endif
+  uint32_t fim = time_us_32();
+  TRACE_END(TRACE_GOVERNADOR);
+
+  permanencia_us[atual] += inicio - desde_us;
+  desde_us = fim;
+  atual = nivel;
+  transicoes[nivel]++;
+  soma_us[nivel] += fim - inicio;
+  if (fim - inicio > max_us[nivel])
+    max_us[nivel] = fim - inicio;
+  return anterior;
+}
+
+void governador_relatorio()
+{
+  uint64_t total = 0;
+  for (uint n = 0; n < GOVERNADOR_NIVEIS; n++)
+    total += permanencia_us[n] + (n == atual ? time_us_32() - desde_us : 0);
+
+  printf("GOVERNADOR clk_sys %lu kHz%s\n", (unsigned long)(clock_get_hz(clk_sys) / 1000),
+         GOVERNADOR_ENABLED ? "" : " (fixo: GOVERNADOR_ENABLED=0)");
+  for (uint n = 0; n < GOVERNADOR_NIVEIS; n++)
+  {
+    uint64_t p = permanencia_us[n] + (n == atual ? time_us_32() - desde_us : 0);
+    printf("  %-6s %6lu kHz: %lu entradas, transicao media %lu us, max %lu us, %lu.%lu%% do tempo\n", nomes[n],
+           (unsigned long)khz[n], (unsigned long)transicoes[n],
+           (unsigned long)(transicoes[n] ? soma_us[n] / transicoes[n] : 0), (unsigned long)max_us[n],
+           (unsigned long)(total ? p * 100 / total : 0), (unsigned long)(total ? p * 1000 / total % 10 : 0));
+  }
+}
@@ -0,0 +1,38 @@
+#ifndef GOVERNADOR_H
+#define GOVERNADOR_H
+
+#include "pico/stdlib.h"
+
+// Governador do clock do sistema: baixa o clk_sys enquanto o firmware só
+// espera e sobe para as rajadas de desenho e despejo. O temporizador do SDK
+// usa clk_ref (cristal) e o USB tem PLL própria; o que deriva de clk_sys e
+// clk_peri (PIO, PWM, I2C e UART) é recalculado a cada mudança.
+// Com GOVERNADOR_ENABLED=0 o clock fica fixo e só o nível é registrado.
+#ifndef GOVERNADOR_ENABLED
+#define GOVERNADOR_ENABLED 1
+#endif
+
+#define GOVERNADOR_KHZ_OCIOSO 48000  // Mínimo com o USB ativo (clk_sys >= clk_usb)
+#define GOVERNADOR_KHZ_NORMAL 125000 // Padrão do SDK no boot
+#define GOVERNADOR_KHZ_RAJADA 133000 // Máximo especificado no datasheet, sem mudar a tensão
+#define GOVERNADOR_LOCKOUT_US 2000   // Espera máxima pela pausa do núcleo 1
+
+typedef enum {
+  GOVERNADOR_OCIOSO,
+  GOVERNADOR_NORMAL,
+  GOVERNADOR_RAJADA,
+  GOVERNADOR_NIVEIS
+} governador_nivel_t;
+
+// Ligação com a aplicação: 'antes' termina as transferências que dependem do
+// clock atual e 'depois' recalcula os divisores para o novo clk_sys (em Hz)
+typedef struct {
+  void (*antes)();
+  void (*depois)(uint32_t hz);
+} governador_app_t;
+
+void governador_init(const governador_app_t *app);
+governador_nivel_t governador_definir(governador_nivel_t nivel);
+void governador_relatorio();
+
+#endif
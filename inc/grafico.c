@@ -0,0 +1,111 @@
+#include "grafico.h"
+#include "trace.h"
+#include <string.h>
+
+void grafico_init(grafico_t *g, ssd1306_t *ssd, uint8_t x, uint8_t largura, uint8_t pagina, uint8_t paginas,
+                  int16_t minimo, int16_t maximo, uint8_t num_series)
+{
+  memset(g, 0, sizeof(*g));
+  g->ssd = ssd;
+  g->x = x;
+  g->largura = largura > GRAFICO_MAX_COLUNAS ? GRAFICO_MAX_COLUNAS : largura;
+  g->pagina = pagina;
+  g->paginas = paginas > 8 ? 8 : paginas;
+  g->minimo = minimo;
+  g->maximo = maximo;
+  g->num_series = num_series > GRAFICO_MAX_SERIES ? GRAFICO_MAX_SERIES : num_series;
+}
+
+// Guarda uma amostra por série no anel; a mais antiga sai quando ele enche
+void grafico_adicionar(grafico_t *g, const int16_t *valores)
+{
+  uint8_t i;
+  if (g->n < g->largura)
+  {
+    i = (g->inicio + g->n++) % g->largura;
+  }
+  else
+  {
+    i = g->inicio;
+    g->inicio = (g->inicio + 1) % g->largura;
+  }
+  memcpy(g->amostras[i], valores, g->num_series * sizeof(int16_t));
+  if (g->pendentes < g->largura)
+    g->pendentes++;
+}
+
+// Linha (0 no topo do gráfico) de um valor, limitado à escala
+static uint8_t linha(const grafico_t *g, int16_t v)
+{
+  uint8_t altura = g->paginas * 8;
+  if (v <= g->minimo)
+    return altura - 1;
+  if (v >= g->maximo)
+    return 0;
+  return (altura - 1) - (uint32_t)(v - g->minimo) * (altura - 1) / (g->maximo - g->minimo);
+}
+
+// Desenha a coluna da amostra k (0 = mais antiga), ligada à anterior por um
+// traço vertical, e escreve as páginas dela direto no buffer
+static void desenhar_coluna(grafico_t *g, uint8_t coluna, int k)
+{
+  uint64_t bits = 0;
+  if (k >= 0)
+  {
+    const int16_t *atual = g->amostras[(g->inicio + k) % g->largura];
+    const int16_t *anterior = k > 0 ? g->amostras[(g->inicio + k - 1) % g->largura] : atual;
+    for (uint8_t s = 0; s < g->num_series; s++)
+    {
+      uint8_t y0 = linha(g, anterior[s]), y1 = linha(g, atual[s]);
+      uint8_t de = y0 < y1 ? y0 : y1, ate = y0 < y1 ? y1 : y0;
+      uint64_t traco = (~0ull >> (63 - ate)) & (~0ull << de);
+      if (s > 0)
+        traco &= 0x5555555555555555ull | 1ull << y1; // Pontilhada, com o ponto da amostra
+      bits |= traco;
+    }
+  }
+
+  uint8_t *destino = &g->ssd->ram_buffer[((g->x + coluna) << 3) + 1 + g->pagina];
+  for (uint8_t p = 0; p < g->paginas; p++)
+    destino[p] = bits >> (8 * p);
+}
+
+// Redesenha todas as colunas a partir do anel (após limpar a tela)
+void grafico_desenhar(grafico_t *g)
+{
+  int vazias = g->largura - g->n;
+  for (uint8_t c = 0; c < g->largura; c++)
+    desenhar_coluna(g, c, c - vazias);
+  g->pendentes = 0;
+}
+
+// Desloca o gráfico pelas amostras pendentes e desenha só as colunas novas.
+// Só vale se o buffer ainda contém o gráfico desenhado antes.
+void grafico_avancar(grafico_t *g)
+{
+  uint8_t d = g->pendentes;
+  if (!d)
+    return;
+  TRACE_BEGIN(TRACE_GRAFICO);
+  uint8_t *base = &g->ssd->ram_buffer[(g->x << 3) + 1];
+  if (g->paginas == g->ssd->pages)
+  {
+    // Altura inteira: as colunas da região são contíguas no buffer
+    memmove(base, base + d * 8, (g->largura - d) * 8);
+  }
+  else
+  {
+    for (uint8_t c = 0; c + d < g->largura; c++)
+      memcpy(base + c * 8 + g->pagina, base + (c + d) * 8 + g->pagina, g->paginas);
+  }
+  for (uint8_t c = g->largura - d; c < g->largura; c++)
+    desenhar_coluna(g, c, g->n - (g->largura - c));
+  g->pendentes = 0;
+  TRACE_END(TRACE_GRAFICO);
+}
+
+// Envia só a região do gráfico ao display
+void grafico_enviar(grafico_t *g)
+{
+  ssd1306_send_window(g->ssd, g->x, g->x + g->largura - 1, g->pagina, g->pagina + g->paginas - 1);
+}
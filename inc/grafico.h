@@ -0,0 +1,33 @@
+#ifndef GRAFICO_H
+#define GRAFICO_H
+
+#include "ssd1306.h"
+
+// Gráfico rolante: cada amostra ocupa uma coluna, a mais recente na
+// direita. As amostras ficam num anel de tamanho fixo; avançar o gráfico
+// desloca a região em colunas inteiras (o buffer do SSD1306 guarda as
+// páginas de cada coluna em sequência) e desenha só a coluna nova, que
+// pode ser enviada sozinha com ssd1306_send_window.
+
+#define GRAFICO_MAX_COLUNAS WIDTH
+#define GRAFICO_MAX_SERIES 2
+
+typedef struct {
+  ssd1306_t *ssd;
+  uint8_t x, largura;        // Colunas ocupadas
+  uint8_t pagina, paginas;   // Páginas ocupadas (altura = 8 * paginas, até 64 linhas)
+  int16_t minimo, maximo;    // Valores nas linhas de baixo e de cima
+  uint8_t num_series;        // A série 0 é contínua; as demais, pontilhadas
+  int16_t amostras[GRAFICO_MAX_COLUNAS][GRAFICO_MAX_SERIES];
+  uint8_t inicio, n;         // Anel: amostra mais antiga e quantidade
+  uint8_t pendentes;         // Amostras ainda não desenhadas no buffer
+} grafico_t;
+
+void grafico_init(grafico_t *g, ssd1306_t *ssd, uint8_t x, uint8_t largura, uint8_t pagina, uint8_t paginas,
+                  int16_t minimo, int16_t maximo, uint8_t num_series);
+void grafico_adicionar(grafico_t *g, const int16_t *valores);
+void grafico_avancar(grafico_t *g);
+void grafico_desenhar(grafico_t *g);
+void grafico_enviar(grafico_t *g);
+
+#endif
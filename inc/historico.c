@@ -0,0 +1,357 @@
+#include "historico.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CABECALHO 16   // magic, seq, boot, tempo base
+#define MAX_REGISTRO 32
+
+static uint32_t ler32(const uint8_t *p)
+{
+  return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void escrever32(uint8_t *p, uint32_t v)
+{
+  for (int i = 0; i < 4; i++)
+    p[i] = v >> (8 * i);
+}
+
+static uint8_t crc8(const uint8_t *dados, size_t n)
+{
+  uint8_t crc = 0;
+  while (n--)
+  {
+    crc ^= *dados++;
+    for (int i = 0; i < 8; i++)
+      crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+  }
+  return crc;
+}
+
+static size_t varint(uint8_t *p, uint32_t v)
+{
+  size_t n = 0;
+  do
+  {
+    p[n++] = (v & 0x7F) | (v > 0x7F ? 0x80 : 0);
+    v >>= 7;
+  } while (v);
+  return n;
+}
+
+static bool ler_varint(const uint8_t **p, const uint8_t *fim, uint32_t *v)
+{
+  *v = 0;
+  for (int desloc = 0; *p < fim && desloc < 35; desloc += 7)
+  {
+    uint8_t b = *(*p)++;
+    *v |= (uint32_t)(b & 0x7F) << desloc;
+    if (!(b & 0x80))
+      return true;
+  }
+  return false;
+}
+
+static const uint8_t *setor_ptr(const historico_t *h, uint32_t setor)
+{
+  return h->flash->base + setor * HISTORICO_SETOR;
+}
+
+static bool setor_valido(const historico_t *h, uint32_t setor)
+{
+  return ler32(setor_ptr(h, setor)) == HISTORICO_MAGICO;
+}
+
+// Grava bytes em posição arbitrária: páginas completadas com 0xFF não
+// alteram o que já estava gravado (a flash só leva bits de 1 para 0)
+static void programar(historico_t *h, uint32_t offset, const uint8_t *dados, size_t n)
+{
+  uint8_t pagina[HISTORICO_PAGINA];
+  while (n)
+  {
+    uint32_t inicio = offset & ~(HISTORICO_PAGINA - 1);
+    uint32_t pos = offset - inicio;
+    size_t parte = HISTORICO_PAGINA - pos < n ? HISTORICO_PAGINA - pos : n;
+    memset(pagina, 0xFF, sizeof(pagina));
+    memcpy(pagina + pos, dados, parte);
+    h->flash->programar_pagina(inicio, pagina);
+    offset += parte;
+    dados += parte;
+    n -= parte;
+  }
+}
+
+// O tempo base do setor é o do último registro: o registro que abre o
+// setor já foi codificado com o delta para ele
+static void abrir_setor(historico_t *h, uint32_t setor, uint32_t seq)
+{
+  uint8_t cab[CABECALHO];
+
+  h->flash->apagar_setor(setor * HISTORICO_SETOR);
+  escrever32(cab, HISTORICO_MAGICO);
+  escrever32(cab + 4, seq);
+  escrever32(cab + 8, h->boot);
+  escrever32(cab + 12, h->ultimo_s);
+  programar(h, setor * HISTORICO_SETOR, cab, sizeof(cab));
+
+  h->setor = setor;
+  h->seq = seq;
+  h->offset = CABECALHO;
+}
+
+// Decodifica o registro em 'offset'; retorna o tamanho ocupado ou 0 no fim
+// do setor (área apagada) ou num registro inválido/incompleto
+static uint32_t decodificar(const historico_t *h, uint32_t setor, uint32_t offset, historico_evento_t *ev, uint32_t *dt, bool *invalido)
+{
+  const uint8_t *p = setor_ptr(h, setor) + offset;
+  *invalido = false;
+  if (offset + 2 > HISTORICO_SETOR || p[0] == 0xFF)
+    return 0;
+
+  uint32_t n = p[0];
+  if (n < 1 || n > MAX_REGISTRO || offset + n + 2 > HISTORICO_SETOR || crc8(p, n + 1) != p[n + 1])
+  {
+    *invalido = true;
+    return 0;
+  }
+
+  const uint8_t *q = p + 2, *fim = p + 1 + n;
+  uint32_t campos[7] = {0};
+  memset(ev, 0, sizeof(*ev));
+  ev->tipo = p[1];
+  *dt = 0;
+
+  if (ev->tipo == HISTORICO_BOOT)
+  {
+    ler_varint(&q, fim, &campos[0]);
+    ev->boot = campos[0];
+  }
+  else
+  {
+    ler_varint(&q, fim, dt);
+    for (int i = 0; i < 6; i++)
+      ler_varint(&q, fim, &campos[i]);
+    ev->estacao = campos[0];
+    ev->flags = campos[1];
+    ev->racao_pedida = campos[2];
+    ev->racao_real = campos[3];
+    ev->agua_pedida = campos[4];
+    ev->agua_real = campos[5];
+  }
+  return n + 2;
+}
+
+// Offset logo após o último registro válido do setor
+static uint32_t fim_registros(const historico_t *h, uint32_t setor, bool *invalido)
+{
+  historico_evento_t ev;
+  uint32_t dt, n, offset = CABECALHO;
+  while ((n = decodificar(h, setor, offset, &ev, &dt, invalido)) > 0)
+    offset += n;
+  return offset;
+}
+
+static bool gravar(historico_t *h, const historico_evento_t *ev)
+{
+  uint8_t reg[MAX_REGISTRO + 2];
+  size_t n = 1;
+  uint32_t agora_s = time_us_64() / 1000000;
+
+  reg[n++] = ev->tipo;
+  if (ev->tipo == HISTORICO_BOOT)
+  {
+    n += varint(&reg[n], ev->boot);
+  }
+  else
+  {
+    n += varint(&reg[n], agora_s - h->ultimo_s);
+    n += varint(&reg[n], ev->estacao);
+    n += varint(&reg[n], ev->flags);
+    n += varint(&reg[n], ev->racao_pedida);
+    n += varint(&reg[n], ev->racao_real);
+    n += varint(&reg[n], ev->agua_pedida);
+    n += varint(&reg[n], ev->agua_real);
+  }
+  reg[0] = n - 1;
+  reg[n] = crc8(reg, n);
+  n++;
+
+  if (h->offset + n > HISTORICO_SETOR)
+  {
+    // Setor cheio: o mais antigo da região é apagado e reaproveitado
+    abrir_setor(h, (h->setor + 1) % h->num_setores, h->seq + 1);
+  }
+  programar(h, h->setor * HISTORICO_SETOR + h->offset, reg, n);
+
+  // Confere a gravação; se falhou, o setor é encerrado e o registro vai para o próximo
+  if (memcmp(setor_ptr(h, h->setor) + h->offset, reg, n) != 0)
+  {
+    abrir_setor(h, (h->setor + 1) % h->num_setores, h->seq + 1);
+    programar(h, h->setor * HISTORICO_SETOR + h->offset, reg, n);
+    if (memcmp(setor_ptr(h, h->setor) + h->offset, reg, n) != 0)
+    {
+      h->offset = HISTORICO_SETOR;
+      return false;
+    }
+  }
+  h->offset += n;
+  h->ultimo_s = ev->tipo == HISTORICO_BOOT ? 0 : agora_s;
+  return true;
+}
+
+void historico_montar(historico_t *h, const historico_flash_t *flash)
+{
+  h->flash = flash;
+  h->num_setores = flash->tamanho / HISTORICO_SETOR;
+  h->boot = 0;
+  h->ultimo_s = 0; // O registro de boot zera o tempo
+
+  // O setor ativo é o de maior sequência
+  bool achou = false;
+  for (uint32_t s = 0; s < h->num_setores; s++)
+  {
+    uint32_t seq = ler32(setor_ptr(h, s) + 4);
+    if (setor_valido(h, s) && (!achou || (int32_t)(seq - h->seq) > 0))
+    {
+      h->setor = s;
+      h->seq = seq;
+      achou = true;
+    }
+  }
+
+  if (!achou)
+  {
+    abrir_setor(h, 0, 1);
+  }
+  else
+  {
+    // Continua após o último registro válido do setor ativo
+    bool invalido;
+    h->offset = fim_registros(h, h->setor, &invalido);
+    if (invalido)
+      h->offset = HISTORICO_SETOR; // Registro incompleto: continua no próximo setor
+
+    // O boot mais recente está no último registro de boot ou no cabeçalho
+    historico_iter_t it;
+    historico_evento_t ev;
+    historico_iniciar_leitura(h, &it);
+    h->boot = ler32(setor_ptr(h, h->setor) + 8);
+    while (historico_proximo(&it, &ev))
+      if (ev.tipo == HISTORICO_BOOT && (int32_t)(ev.boot - h->boot) > 0)
+        h->boot = ev.boot;
+  }
+
+  historico_evento_t boot = {.tipo = HISTORICO_BOOT, .boot = ++h->boot};
+  gravar(h, &boot);
+}
+
+bool historico_registrar(historico_t *h, const historico_evento_t *ev)
+{
+  if (ev->tipo == HISTORICO_BOOT)
+    return false; // Registrado só por historico_montar
+  return gravar(h, ev);
+}
+
+// Próximo setor em ordem de sequência a partir de 'seq'
+static bool buscar_setor(const historico_t *h, uint32_t seq, uint32_t *setor)
+{
+  for (uint32_t s = 0; s < h->num_setores; s++)
+  {
+    if (setor_valido(h, s) && ler32(setor_ptr(h, s) + 4) == seq)
+    {
+      *setor = s;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void entrar_setor(historico_iter_t *it, uint32_t setor)
+{
+  const uint8_t *p = setor_ptr(it->h, setor);
+  it->setor = setor;
+  it->offset = CABECALHO;
+  it->boot = ler32(p + 8);
+  it->tempo_s = ler32(p + 12);
+}
+
+void historico_iniciar_leitura(const historico_t *h, historico_iter_t *it)
+{
+  it->h = h;
+  // O mais antigo tem a menor sequência entre os setores válidos
+  it->seq = h->seq;
+  for (uint32_t s = 0; s < h->num_setores; s++)
+  {
+    uint32_t seq = ler32(setor_ptr(h, s) + 4);
+    if (setor_valido(h, s) && (int32_t)(seq - it->seq) < 0)
+      it->seq = seq;
+  }
+  if (buscar_setor(h, it->seq, &it->setor))
+    entrar_setor(it, it->setor);
+  else
+    it->offset = HISTORICO_SETOR;
+}
+
+bool historico_proximo(historico_iter_t *it, historico_evento_t *ev)
+{
+  while (true)
+  {
+    uint32_t dt, n;
+    bool invalido;
+    if (it->offset < HISTORICO_SETOR && (n = decodificar(it->h, it->setor, it->offset, ev, &dt, &invalido)) > 0)
+    {
+      it->offset += n;
+      if (ev->tipo == HISTORICO_BOOT)
+      {
+        it->boot = ev->boot;
+        it->tempo_s = 0;
+      }
+      else
+      {
+        it->tempo_s += dt;
+        ev->boot = it->boot;
+      }
+      ev->tempo_s = it->tempo_s;
+      return true;
+    }
+
+    // Fim do setor: segue para o próximo da sequência
+    if (it->seq == it->h->seq)
+      return false;
+    uint32_t setor;
+    it->seq++;
+    if (buscar_setor(it->h, it->seq, &setor))
+      entrar_setor(it, setor);
+    else
+      it->offset = HISTORICO_SETOR;
+  }
+}
+
+// Exporta os setores em ordem, em hexadecimal, lendo direto da flash:
+// só uma linha de 32 bytes passa pela RAM de cada vez.
+// Decodifique a captura com tools/historico_decode.py.
+void historico_exportar(const historico_t *h)
+{
+  historico_iter_t it;
+
+  printf("HISTORICO %lu\n", (unsigned long)h->num_setores);
+  historico_iniciar_leitura(h, &it);
+  for (uint32_t seq = it.seq; (int32_t)(seq - h->seq) <= 0; seq++)
+  {
+    uint32_t setor;
+    bool invalido;
+    if (!buscar_setor(h, seq, &setor))
+      continue;
+
+    const uint8_t *p = setor_ptr(h, setor);
+    uint32_t fim = fim_registros(h, setor, &invalido);
+    printf("SETOR %lu\n", (unsigned long)seq);
+    for (uint32_t inicio = 0; inicio < fim; inicio += 32)
+    {
+      for (uint32_t i = inicio; i < fim && i < inicio + 32; i++)
+        printf("%02x", p[i]);
+      printf("\n");
+    }
+  }
+  printf("HISTORICO_FIM\n");
+}
@@ -0,0 +1,75 @@
+#ifndef HISTORICO_H
+#define HISTORICO_H
+
+#include "pico/stdlib.h"
+
+// Histórico de alimentações numa região circular da flash.
+//
+// Cada setor começa com um cabeçalho (magic "HST1", sequência, boot e
+// tempo base, 4 x uint32 little-endian) seguido de registros:
+//   [tamanho][tipo][campos em varint...][crc8]
+// O tempo de cada registro é a diferença, em segundos, para o registro
+// anterior (ou para o tempo base do setor). Um registro é gravado de uma
+// vez e validado pelo CRC; um registro incompleto por falta de energia
+// encerra o setor e a gravação segue no próximo.
+
+#define HISTORICO_SETOR 4096
+#define HISTORICO_PAGINA 256
+#define HISTORICO_MAGICO 0x31545348 // "HST1"
+
+// Acesso à flash: leitura direta da memória e escrita por página
+typedef struct {
+  uint32_t tamanho;    // Bytes da região, múltiplo de HISTORICO_SETOR
+  const uint8_t *base; // Região mapeada para leitura (XIP no RP2040)
+  void (*apagar_setor)(uint32_t offset);
+  void (*programar_pagina)(uint32_t offset, const uint8_t *pagina);
+} historico_flash_t;
+
+typedef enum {
+  HISTORICO_BOOT,        // Início de uma execução; o tempo volta a 0
+  HISTORICO_ALIMENTACAO, // Despejo concluído: pedido x dispensado
+  HISTORICO_ALERTA       // Estoque insuficiente: pedido x estoque disponível
+} historico_tipo_t;
+
+enum {
+  HISTORICO_AUTOMATICO = 1 << 0, // Disparado pelo modo automático
+  HISTORICO_FALTA_RACAO = 1 << 1,
+  HISTORICO_FALTA_AGUA = 1 << 2
+};
+
+typedef struct {
+  historico_tipo_t tipo;
+  uint32_t boot;
+  uint32_t tempo_s; // Segundos desde o boot
+  uint8_t estacao;
+  uint8_t flags;
+  uint16_t racao_pedida, racao_real; // real: dispensada ou, num alerta, em estoque
+  uint16_t agua_pedida, agua_real;
+} historico_evento_t;
+
+typedef struct {
+  const historico_flash_t *flash;
+  uint32_t num_setores;
+  uint32_t setor, offset; // Posição da próxima gravação
+  uint32_t seq;           // Sequência do setor ativo
+  uint32_t boot;
+  uint32_t ultimo_s;      // Tempo do último registro (base dos deltas)
+} historico_t;
+
+typedef struct {
+  const historico_t *h;
+  uint32_t seq, setor, offset;
+  uint32_t boot, tempo_s;
+} historico_iter_t;
+
+// Região da flash usada pelo firmware (historico_flash.c no alvo, RAM no simulador)
+const historico_flash_t *historico_flash_padrao();
+
+void historico_montar(historico_t *h, const historico_flash_t *flash);
+bool historico_registrar(historico_t *h, const historico_evento_t *ev);
+
+void historico_iniciar_leitura(const historico_t *h, historico_iter_t *it);
+bool historico_proximo(historico_iter_t *it, historico_evento_t *ev);
+void historico_exportar(const historico_t *h);
+
+#endif
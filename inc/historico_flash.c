@@ -0,0 +1,47 @@
+#include "historico.h"
+#include "hardware/flash.h"
+#include "hardware/regs/addressmap.h"
+#include "pico/flash.h"
+
+// Últimos setores da flash, longe do programa
+#define HISTORICO_NUM_SETORES 8
+#define HISTORICO_OFFSET (PICO_FLASH_SIZE_BYTES - HISTORICO_NUM_SETORES * FLASH_SECTOR_SIZE)
+
+typedef struct {
+  uint32_t offset;
+  const uint8_t *pagina;
+} historico_escrita_t;
+
+static void apagar_seguro(void *param)
+{
+  flash_range_erase(((historico_escrita_t *)param)->offset, FLASH_SECTOR_SIZE);
+}
+
+static void programar_seguro(void *param)
+{
+  historico_escrita_t *e = param;
+  flash_range_program(e->offset, e->pagina, FLASH_PAGE_SIZE);
+}
+
+// flash_safe_execute pausa o núcleo 1 (que executa da flash) durante a escrita
+static void apagar_setor(uint32_t offset)
+{
+  historico_escrita_t e = {HISTORICO_OFFSET + offset, NULL};
+  flash_safe_execute(apagar_seguro, &e, UINT32_MAX);
+}
+
+static void programar_pagina(uint32_t offset, const uint8_t *pagina)
+{
+  historico_escrita_t e = {HISTORICO_OFFSET + offset, pagina};
+  flash_safe_execute(programar_seguro, &e, UINT32_MAX);
+}
+
+const historico_flash_t *historico_flash_padrao()
+{
+  static const historico_flash_t flash = {
+      HISTORICO_NUM_SETORES * FLASH_SECTOR_SIZE,
+      (const uint8_t *)(XIP_BASE + HISTORICO_OFFSET),
+      apagar_setor,
+      programar_pagina};
+  return &flash;
+}
@@ -0,0 +1,123 @@
+#include "latencia.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+
+static const char *const nomes[] = {"botao", "joystick", "todas"};
+
+static volatile bool pendente = false;  // Há uma entrada ainda não refletida no painel
+static volatile uint32_t entrada_us = 0; // Momento da entrada pendente mais antiga
+static volatile latencia_origem_t origem_pendente;
+
+static uint32_t faixas[LATENCIA_NUM_ORIGENS][LATENCIA_NUM_FAIXAS];
+static uint32_t maxima_us[LATENCIA_NUM_ORIGENS];
+
+void latencia_entrada(latencia_origem_t origem)
+{
+  latencia_entrada_em(origem, time_us_32());
+}
+
+void latencia_entrada_em(latencia_origem_t origem, uint32_t tempo_us)
+{
+  uint32_t status = save_and_disable_interrupts(); // Chamada também pelas interrupções de GPIO
+  if (!pendente || (int32_t)(tempo_us - entrada_us) < 0)
+  {
+    entrada_us = tempo_us;
+    origem_pendente = origem;
+    pendente = true;
+  }
+  restore_interrupts(status);
+}
+
+// Um quadro só reflete a entrada se começou a ser enviado depois dela
+void latencia_quadro(uint32_t inicio_us)
+{
+  uint32_t agora = time_us_32();
+  uint32_t status = save_and_disable_interrupts();
+  if (!pendente || (int32_t)(inicio_us - entrada_us) < 0)
+  {
+    restore_interrupts(status);
+    return;
+  }
+  uint32_t lat_us = agora - entrada_us;
+  latencia_origem_t origem = origem_pendente;
+  pendente = false;
+  restore_interrupts(status);
+
+  uint32_t faixa = lat_us / (LATENCIA_FAIXA_MS * 1000);
+  if (faixa >= LATENCIA_NUM_FAIXAS)
+    faixa = LATENCIA_NUM_FAIXAS - 1;
+  faixas[origem][faixa]++;
+  if (lat_us > maxima_us[origem])
+    maxima_us[origem] = lat_us;
+}
+
+static uint32_t contagem(latencia_origem_t origem, uint faixa)
+{
+  if (origem != LATENCIA_TODAS)
+    return faixas[origem][faixa];
+  uint32_t total = 0;
+  for (uint o = 0; o < LATENCIA_NUM_ORIGENS; o++)
+    total += faixas[o][faixa];
+  return total;
+}
+
+uint32_t latencia_amostras(latencia_origem_t origem)
+{
+  uint32_t total = 0;
+  for (uint i = 0; i < LATENCIA_NUM_FAIXAS; i++)
+    total += contagem(origem, i);
+  return total;
+}
+
+// Limite superior da faixa que contém o percentil pedido
+uint32_t latencia_percentil_ms(latencia_origem_t origem, uint percentil)
+{
+  uint32_t total = latencia_amostras(origem);
+  if (total == 0)
+    return 0;
+  uint32_t alvo = (total * percentil + 99) / 100;
+  uint32_t acumulado = 0;
+  for (uint i = 0; i < LATENCIA_NUM_FAIXAS; i++)
+  {
+    acumulado += contagem(origem, i);
+    if (acumulado >= alvo)
+      return (i + 1) * LATENCIA_FAIXA_MS;
+  }
+  return LATENCIA_NUM_FAIXAS * LATENCIA_FAIXA_MS;
+}
+
+uint32_t latencia_maxima_ms(latencia_origem_t origem)
+{
+  if (origem != LATENCIA_TODAS)
+    return maxima_us[origem] / 1000;
+  uint32_t m = 0;
+  for (uint o = 0; o < LATENCIA_NUM_ORIGENS; o++)
+    if (maxima_us[o] > m)
+      m = maxima_us[o];
+  return m / 1000;
+}
+
+bool latencia_dentro_orcamento()
+{
+  return latencia_percentil_ms(LATENCIA_TODAS, 99) <= LATENCIA_ORCAMENTO_P99_MS;
+}
+
+void latencia_relatorio()
+{
+  printf("LATENCIA entrada->painel (orcamento p99 %d ms)\n", LATENCIA_ORCAMENTO_P99_MS);
+  for (uint o = 0; o <= LATENCIA_TODAS; o++)
+  {
+    printf("  %-8s n=%lu p50<=%lu ms p99<=%lu ms max=%lu ms\n", nomes[o],
+           (unsigned long)latencia_amostras(o), (unsigned long)latencia_percentil_ms(o, 50),
+           (unsigned long)latencia_percentil_ms(o, 99), (unsigned long)latencia_maxima_ms(o));
+  }
+
+  // Histograma combinado, só faixas não vazias
+  for (uint i = 0; i < LATENCIA_NUM_FAIXAS; i++)
+  {
+    uint32_t n = contagem(LATENCIA_TODAS, i);
+    if (n)
+      printf("  %3u-%3u ms: %lu\n", i * LATENCIA_FAIXA_MS, (i + 1) * LATENCIA_FAIXA_MS, (unsigned long)n);
+  }
+  printf("  %s\n", latencia_dentro_orcamento() ? "OK" : "ORCAMENTO ESTOURADO");
+}
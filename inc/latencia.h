@@ -0,0 +1,34 @@
+#ifndef LATENCIA_H
+#define LATENCIA_H
+
+#include "pico/stdlib.h"
+
+// Orçamento de latência entrada -> painel (p99). Pode ser redefinido na
+// compilação; o simulador do host falha o build se for ultrapassado.
+#ifndef LATENCIA_ORCAMENTO_P99_MS
+#define LATENCIA_ORCAMENTO_P99_MS 400
+#endif
+
+#define LATENCIA_FAIXA_MS 10   // Largura de cada faixa do histograma
+#define LATENCIA_NUM_FAIXAS 64 // A última faixa acumula tudo acima de 630 ms
+
+typedef enum {
+  LATENCIA_BOTAO,    // Borda de um botão (A, B ou joystick)
+  LATENCIA_JOYSTICK, // Joystick cruzando o limiar de ±500
+  LATENCIA_NUM_ORIGENS,
+  LATENCIA_TODAS = LATENCIA_NUM_ORIGENS
+} latencia_origem_t;
+
+// Marca uma entrada; só a mais antiga ainda não exibida é medida
+void latencia_entrada(latencia_origem_t origem);
+void latencia_entrada_em(latencia_origem_t origem, uint32_t tempo_us);
+// Fim de um quadro enviado ao display que começou em inicio_us
+void latencia_quadro(uint32_t inicio_us);
+
+uint32_t latencia_amostras(latencia_origem_t origem);
+uint32_t latencia_percentil_ms(latencia_origem_t origem, uint percentil);
+uint32_t latencia_maxima_ms(latencia_origem_t origem);
+bool latencia_dentro_orcamento();
+void latencia_relatorio();
+
+#endif
@@ -0,0 +1,262 @@
+#include "protocolo.h"
+#include "dlog.h"
+#include "espelho.h"
+#include "repouso.h"
+#include <string.h>
+
+static const protocolo_app_t *app = NULL;
+
+// Quadro em recepção; o payload é lido direto daqui, sem cópia
+static uint8_t rx[PROTOCOLO_MAX_QUADRO];
+static size_t rx_n = 0;
+static uint32_t rx_ultimo_us = 0;
+
+// Telemetria: o período é escrito pelo núcleo 0 e lido pelo núcleo 1
+static volatile uint32_t periodo_ms = 0;
+static volatile bool reiniciar = false;
+static uint64_t proxima_ms = 0;
+static uint8_t seq_telemetria = 0;
+
+static uint16_t crc16(const uint8_t *dados, size_t n)
+{
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < n; i++)
+  {
+    crc ^= (uint16_t)dados[i] << 8;
+    for (int b = 0; b < 8; b++)
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+static int32_t ler32(const uint8_t *p)
+{
+  return (int32_t)(p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24);
+}
+
+static void escrever32(uint8_t *p, int32_t v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+// Monta e envia um quadro de uma vez: o stdio serializa cada chamada,
+// então respostas (núcleo 0), telemetria e espelho (núcleo 1) não se
+// misturam. Sem tradução de \n para \r\n, que corromperia o binário.
+void protocolo_enviar(uint8_t tipo, uint8_t seq, const uint8_t *payload, size_t n)
+{
+  uint8_t q[PROTOCOLO_MAX_QUADRO];
+  q[0] = PROTOCOLO_SOF;
+  q[1] = n;
+  q[2] = tipo;
+  q[3] = seq;
+  memcpy(q + PROTOCOLO_CABECALHO, payload, n);
+  uint16_t crc = crc16(q + 1, n + PROTOCOLO_CABECALHO - 1);
+  q[PROTOCOLO_CABECALHO + n] = crc;
+  q[PROTOCOLO_CABECALHO + n + 1] = crc >> 8;
+  stdio_put_string((const char *)q, n + PROTOCOLO_CABECALHO + 2, false, false);
+}
+
+static void responder(uint8_t tipo, uint8_t seq, uint8_t status, uint8_t extra)
+{
+  uint8_t p[2] = {status, extra};
+  protocolo_enviar(tipo | PROTOCOLO_RESPOSTA, seq, p, 2);
+}
+
+// Escreve todos os campos legíveis a partir de 'destino'
+static size_t campos(uint8_t *destino)
+{
+  size_t n = 0;
+  for (uint8_t c = 1; c < CAMPO_NUM; c++)
+  {
+    int32_t v;
+    if (app->obter(c, &v))
+    {
+      destino[n] = c;
+      escrever32(destino + n + 1, v);
+      n += PROTOCOLO_TAM_CAMPO;
+    }
+  }
+  return n;
+}
+
+static void definir(uint8_t seq, const uint8_t *p, size_t n)
+{
+  if (n % PROTOCOLO_TAM_CAMPO)
+  {
+    responder(PROTOCOLO_DEFINIR, seq, PROTOCOLO_ERRO_TAMANHO, 0);
+    return;
+  }
+
+  // Valida o lote inteiro antes de aplicar qualquer campo
+  size_t num = n / PROTOCOLO_TAM_CAMPO;
+  for (size_t i = 0; i < num; i++)
+  {
+    const uint8_t *c = p + i * PROTOCOLO_TAM_CAMPO;
+    if (c[0] == 0 || c[0] >= CAMPO_NUM || c[0] == CAMPO_TEMPO_MS)
+    {
+      responder(PROTOCOLO_DEFINIR, seq, PROTOCOLO_ERRO_CAMPO, i);
+      return;
+    }
+    if (!app->definir(c[0], ler32(c + 1), false))
+    {
+      responder(PROTOCOLO_DEFINIR, seq, PROTOCOLO_ERRO_VALOR, i);
+      return;
+    }
+  }
+  for (size_t i = 0; i < num; i++)
+  {
+    const uint8_t *c = p + i * PROTOCOLO_TAM_CAMPO;
+    app->definir(c[0], ler32(c + 1), true);
+  }
+  DLOG1(DLOG_CONFIG_REMOTA, num);
+  responder(PROTOCOLO_DEFINIR, seq, PROTOCOLO_OK, num);
+}
+
+static void processar(uint8_t tipo, uint8_t seq, const uint8_t *p, size_t n)
+{
+  switch (tipo)
+  {
+  case PROTOCOLO_PING:
+    responder(tipo, seq, PROTOCOLO_OK, PROTOCOLO_VERSAO);
+    break;
+
+  case PROTOCOLO_DEFINIR:
+    definir(seq, p, n);
+    break;
+
+  case PROTOCOLO_LER:
+  {
+    uint8_t r[PROTOCOLO_MAX_PAYLOAD];
+    r[0] = PROTOCOLO_OK;
+    protocolo_enviar(tipo | PROTOCOLO_RESPOSTA, seq, r, 1 + campos(r + 1));
+    break;
+  }
+
+  case PROTOCOLO_TELEMETRIA_PERIODO:
+  {
+    uint32_t ms = n == 2 ? p[0] | p[1] << 8 : 0;
+    if (n != 2)
+      responder(tipo, seq, PROTOCOLO_ERRO_TAMANHO, 0);
+    else if (ms && ms < PROTOCOLO_TELEMETRIA_MIN_MS)
+      responder(tipo, seq, PROTOCOLO_ERRO_VALOR, 0);
+    else
+    {
+      periodo_ms = ms;
+      reiniciar = true;
+      responder(tipo, seq, PROTOCOLO_OK, 0);
+    }
+    break;
+  }
+
+  case PROTOCOLO_ALIMENTAR:
+    app->alimentar();
+    responder(tipo, seq, PROTOCOLO_OK, 0);
+    break;
+
+  case PROTOCOLO_ESPELHO:
+  {
+    uint32_t bytes_s = n == 2 ? p[0] | p[1] << 8 : 0;
+    if (n != 2)
+      responder(tipo, seq, PROTOCOLO_ERRO_TAMANHO, 0);
+    else if (!espelho_definir(bytes_s))
+      responder(tipo, seq, PROTOCOLO_ERRO_VALOR, 0);
+    else
+      responder(tipo, seq, PROTOCOLO_OK, 0);
+    break;
+  }
+
+  default:
+  {
+    uint8_t r[2] = {PROTOCOLO_ERRO_TIPO, tipo};
+    protocolo_enviar(PROTOCOLO_ERRO, seq, r, 2);
+    break;
+  }
+  }
+}
+
+// Remove n bytes do início do buffer e avança até o próximo SOF
+static void descartar(size_t n)
+{
+  while (n < rx_n && rx[n] != PROTOCOLO_SOF)
+    n++;
+  memmove(rx, rx + n, rx_n - n);
+  rx_n -= n;
+}
+
+// Trata os quadros completos no início do buffer
+static void analisar()
+{
+  while (rx_n >= 2)
+  {
+    if (rx[1] > PROTOCOLO_MAX_PAYLOAD)
+    {
+      descartar(1);
+      continue;
+    }
+    size_t n = rx[1] + PROTOCOLO_CABECALHO + 2;
+    if (rx_n < n)
+      return;
+
+    uint16_t crc = rx[n - 2] | rx[n - 1] << 8;
+    if (crc16(rx + 1, n - 3) == crc)
+    {
+      processar(rx[2], rx[3], rx + PROTOCOLO_CABECALHO, rx[1]);
+      descartar(n);
+    }
+    else
+    {
+      descartar(1); // CRC inválido: procura o próximo SOF
+    }
+  }
+}
+
+void protocolo_init(const protocolo_app_t *a)
+{
+  app = a;
+}
+
+// Lê o que chegou pela serial e processa os quadros completos.
+// Retorna o próximo comando de texto, ou PICO_ERROR_TIMEOUT se não houver.
+int protocolo_receber()
+{
+  int c;
+  while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT)
+  {
+    repouso_uso_serial(); // Comandos e quadros adiam o repouso
+    if (rx_n == 0 && c != PROTOCOLO_SOF)
+      return c;
+    rx[rx_n++] = c;
+    rx_ultimo_us = time_us_32();
+    analisar();
+  }
+
+  // Quadro interrompido no meio: descarta para não engolir os próximos comandos
+  if (rx_n && time_us_32() - rx_ultimo_us > PROTOCOLO_TIMEOUT_US)
+    rx_n = 0;
+  return PICO_ERROR_TIMEOUT;
+}
+
+// Chamada a cada ciclo do núcleo 1: envia um retrato do estado no período pedido
+void protocolo_telemetria()
+{
+  uint32_t periodo = periodo_ms;
+  if (!periodo || !app)
+    return;
+
+  uint64_t agora = time_us_64() / 1000;
+  if (reiniciar)
+  {
+    reiniciar = false;
+    proxima_ms = agora;
+  }
+  if (agora < proxima_ms)
+    return;
+  // Sem rajadas para recuperar ciclos perdidos (ex.: núcleo 1 pausado pela flash)
+  proxima_ms = proxima_ms + periodo > agora ? proxima_ms + periodo : agora + periodo;
+
+  uint8_t p[PROTOCOLO_MAX_PAYLOAD];
+  protocolo_enviar(PROTOCOLO_TELEMETRIA, seq_telemetria++, p, campos(p));
+}
@@ -0,0 +1,74 @@
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include "pico/stdlib.h"
+
+// Protocolo binário de controle pela serial USB (a mesma do stdio).
+//
+// Quadro: SOF | tamanho | tipo | seq | payload[tamanho] | crc16 (LE)
+// O CRC-16/CCITT (0x1021, início 0xFFFF) cobre de 'tamanho' ao fim do
+// payload. Cada pedido recebe uma resposta com tipo | 0x80, o mesmo seq e
+// o primeiro byte do payload com o status. Bytes recebidos fora de um
+// quadro continuam sendo os comandos de texto de uma letra (T, L, R, H).
+//
+// Configuração e telemetria usam uma lista de campos de 5 bytes:
+//   campo (1 byte) | valor int32 little-endian
+// Um PROTOCOLO_DEFINIR aplica todos os campos ou nenhum.
+
+#define PROTOCOLO_SOF 0xA5
+#define PROTOCOLO_VERSAO 1
+#define PROTOCOLO_MAX_PAYLOAD 64
+#define PROTOCOLO_CABECALHO 4                                   // SOF, tamanho, tipo, seq
+#define PROTOCOLO_MAX_QUADRO (PROTOCOLO_CABECALHO + PROTOCOLO_MAX_PAYLOAD + 2)
+#define PROTOCOLO_TAM_CAMPO 5
+#define PROTOCOLO_TIMEOUT_US 100000                             // Descarta um quadro incompleto parado por mais que isso
+#define PROTOCOLO_TELEMETRIA_MIN_MS 20                          // Período do laço do núcleo 1 (DLOG_PERIODO_MS)
+
+typedef enum {
+  PROTOCOLO_PING = 0x01,                 // Resposta: status, versão
+  PROTOCOLO_DEFINIR = 0x02,              // Lote de campos; resposta: status, índice do campo recusado
+  PROTOCOLO_LER = 0x03,                  // Resposta: status, todos os campos
+  PROTOCOLO_TELEMETRIA_PERIODO = 0x04,   // uint16 em ms (0 desliga); resposta: status
+  PROTOCOLO_ALIMENTAR = 0x05,            // Dispara um despejo; resposta: status
+  PROTOCOLO_ESPELHO = 0x06,              // uint16 em bytes/s (0 desliga); resposta: status (inc/espelho.h)
+  PROTOCOLO_RESPOSTA = 0x80,             // Somado ao tipo do pedido
+  PROTOCOLO_TELEMETRIA = 0x90,           // Enviado sem pedido: todos os campos
+  PROTOCOLO_ESPELHO_DADOS = 0x91,        // Enviado sem pedido: diferenças do display
+  PROTOCOLO_ESPELHO_QUADRO = 0x92,       // Enviado sem pedido: quadro completo (número e hash)
+  PROTOCOLO_ERRO = 0xFF                  // Resposta a um tipo desconhecido
+} protocolo_tipo_t;
+
+typedef enum {
+  PROTOCOLO_OK = 0,
+  PROTOCOLO_ERRO_TIPO = 1,
+  PROTOCOLO_ERRO_TAMANHO = 2,
+  PROTOCOLO_ERRO_CAMPO = 3,
+  PROTOCOLO_ERRO_VALOR = 4
+} protocolo_status_t;
+
+typedef enum {
+  CAMPO_RACAO_PORCAO = 1,   // g por despejo (1..500)
+  CAMPO_AGUA_PORCAO = 2,    // ml por despejo (1..500)
+  CAMPO_INTERVALO_H = 3,    // Intervalo do modo automático (1..23)
+  CAMPO_MODO_AUTO = 4,      // 0 manual, 1 automático
+  CAMPO_ESTOQUE_RACAO = 5,  // g disponíveis (0..1000)
+  CAMPO_ESTOQUE_AGUA = 6,   // ml disponíveis (0..1000)
+  CAMPO_TEMPO_MS = 7,       // Somente leitura: ms desde o boot
+  CAMPO_NUM
+} protocolo_campo_t;
+
+// Ligação com a aplicação. 'definir' é chamado duas vezes por lote:
+// primeiro só para validar (aplicar = false) e depois para aplicar.
+// 'obter' também é chamado no núcleo 1 para montar a telemetria.
+typedef struct {
+  bool (*definir)(uint8_t campo, int32_t valor, bool aplicar);
+  bool (*obter)(uint8_t campo, int32_t *valor);
+  void (*alimentar)();
+} protocolo_app_t;
+
+void protocolo_init(const protocolo_app_t *app);
+int protocolo_receber();
+void protocolo_telemetria();
+void protocolo_enviar(uint8_t tipo, uint8_t seq, const uint8_t *payload, size_t n);
+
+#endif
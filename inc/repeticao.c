@@ -0,0 +1,53 @@
+#include "repeticao.h"
+
+// Esquece a inclinação em andamento (ao abrir um editor com o eixo ainda inclinado)
+void repeticao_reiniciar(repeticao_t *r)
+{
+  r->direcao = 0;
+  r->acumulado = 0;
+}
+
+// Passos a aplicar agora: positivo acima do centro, negativo abaixo
+int repeticao_passos(repeticao_t *r, uint16_t adc)
+{
+  const repeticao_curva_t *c = r->curva;
+  int desvio = (int)adc - REPETICAO_CENTRO;
+  int8_t direcao = desvio > c->zona_morta ? 1 : desvio < -(int)c->zona_morta ? -1 : 0;
+  uint64_t agora = time_us_64();
+
+  if (direcao != r->direcao)
+  {
+    // Soltou ou inverteu: a nova inclinação dá um passo imediato
+    r->direcao = direcao;
+    r->inicio_us = agora;
+    r->ultimo_us = agora;
+    r->acumulado = 0;
+    return direcao;
+  }
+  if (!direcao)
+    return 0;
+
+  uint64_t repetir_us = r->inicio_us + c->atraso_ms * 1000ull;
+  if (agora <= repetir_us)
+    return 0;
+  uint64_t desde = r->ultimo_us > repetir_us ? r->ultimo_us : repetir_us;
+  r->ultimo_us = agora;
+
+  // Fração do curso além da zona morta, em 1/1024
+  uint32_t modulo = desvio < 0 ? -desvio : desvio;
+  uint32_t f = (modulo - c->zona_morta) * 1024 / (REPETICAO_CURSO - c->zona_morta);
+  if (f > 1024)
+    f = 1024;
+
+  uint32_t segurando_ms = (agora - repetir_us) / 1000;
+  if (segurando_ms > REPETICAO_SEGURAR_MAX_MS)
+    segurando_ms = REPETICAO_SEGURAR_MAX_MS;
+  uint32_t taxa = c->taxa_min + ((c->taxa_max - c->taxa_min) * f >> 10) + (c->aceleracao * f >> 10) * segurando_ms / 1000;
+  if (taxa > c->taxa_limite)
+    taxa = c->taxa_limite;
+
+  r->acumulado += taxa * (agora - desde);
+  int passos = r->acumulado / 1000000;
+  r->acumulado -= passos * 1000000ull;
+  return direcao * passos;
+}
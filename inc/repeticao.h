@@ -0,0 +1,44 @@
+#ifndef REPETICAO_H
+#define REPETICAO_H
+
+#include "pico/stdlib.h"
+
+// Auto-repetição com aceleração para um eixo do joystick. A inclinação
+// gera um passo na hora; depois de 'atraso_ms' segurando, os passos seguem
+// numa taxa que cresce com o desvio do centro e com o tempo segurando.
+// A taxa é integrada no tempo, então o resultado não depende do período
+// de leitura de quem chama.
+//
+//   taxa (passos/s) = taxa_min + f * (taxa_max - taxa_min) + f * aceleracao * t
+//
+// com f = 0 na borda da zona morta e 1 no fim do curso, e t o tempo
+// segurando além do atraso. A taxa é limitada a 'taxa_limite'.
+
+#define REPETICAO_CENTRO 2047       // Leitura do ADC com o joystick solto
+#define REPETICAO_CURSO 2047        // Desvio máximo a partir do centro
+#define REPETICAO_PERIODO_MS 20     // Período de leitura dos editores
+#define REPETICAO_SEGURAR_MAX_MS 60000 // Tempo segurando considerado na aceleração
+
+typedef struct {
+  uint16_t zona_morta;   // Desvio do centro abaixo do qual o eixo está solto
+  uint16_t atraso_ms;    // Espera entre o primeiro passo e a repetição
+  uint16_t taxa_min;     // Passos/s logo após a zona morta
+  uint16_t taxa_max;     // Passos/s no fim do curso, sem aceleração
+  uint16_t aceleracao;   // Passos/s ganhos por segundo segurando (no fim do curso)
+  uint16_t taxa_limite;  // Passos/s máximos
+} repeticao_curva_t;
+
+typedef struct {
+  const repeticao_curva_t *curva;
+  int8_t direcao;        // -1, 0 (solto) ou +1
+  uint64_t inicio_us;    // Início da inclinação atual
+  uint64_t ultimo_us;    // Última leitura integrada
+  uint64_t acumulado;    // Fração de passo pendente (em passos * 1e6)
+} repeticao_t;
+
+#define REPETICAO_INIT(c) {(c), 0, 0, 0, 0}
+
+void repeticao_reiniciar(repeticao_t *r);
+int repeticao_passos(repeticao_t *r, uint16_t adc);
+
+#endif
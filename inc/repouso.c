@@ -0,0 +1,155 @@
+#include "repouso.h"
+#include "entrada.h"
+#include "dlog.h"
+#include "trace.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include "hardware/structs/scb.h"
+#include <stdio.h>
+
+// Clocks cortados quando os dois núcleos estão em WFI/WFE com SLEEPDEEP (o
+// núcleo 0 em repouso_dormir, o núcleo 1 estacionado pelo dlog): PIO
+// (matriz parada), I2C (painel desligado), ADC, DMA, SPI e UART1 (sem uso).
+// PWM (servo), timer, USB e UART0 continuam.
+#define REPOUSO_SEM_CLOCK_EN0                                                                       \
+  (CLOCKS_SLEEP_EN0_CLK_SYS_PIO0_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_PIO1_BITS |                         \
+   CLOCKS_SLEEP_EN0_CLK_SYS_I2C0_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_I2C1_BITS |                         \
+   CLOCKS_SLEEP_EN0_CLK_SYS_ADC_BITS | CLOCKS_SLEEP_EN0_CLK_ADC_ADC_BITS |                           \
+   CLOCKS_SLEEP_EN0_CLK_SYS_DMA_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_SPI0_BITS |                          \
+   CLOCKS_SLEEP_EN0_CLK_PERI_SPI0_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_SPI1_BITS |                        \
+   CLOCKS_SLEEP_EN0_CLK_PERI_SPI1_BITS)
+#define REPOUSO_SEM_CLOCK_EN1 (CLOCKS_SLEEP_EN1_CLK_SYS_UART1_BITS | CLOCKS_SLEEP_EN1_CLK_PERI_UART1_BITS)
+
+static const repouso_app_t *app = NULL;
+static volatile bool dormindo = false;
+static volatile repouso_origem_t origem_despertar = REPOUSO_TIMER;
+static volatile uint32_t despertar_us = 0;
+static volatile bool aguardando_quadro = false;
+static uint64_t ultima_serial_us = 0; // Último byte recebido pela serial (comando ou protocolo)
+
+// Estatísticas
+static uint32_t despertares[REPOUSO_NUM_ORIGENS];
+static uint64_t dormindo_total_us = 0;
+static uint32_t quadros = 0;
+static uint64_t quadro_soma_us = 0;
+static uint32_t quadro_max_us = 0;
+
+static const char *const nomes[REPOUSO_NUM_ORIGENS] = {"timer", "botao", "serial"};
+
+void repouso_init(const repouso_app_t *a)
+{
+  app = a;
+}
+
+// Sem uso dos botões, do joystick ou da serial há REPOUSO_APOS_MS
+bool repouso_ocioso()
+{
+  uint64_t ultima = entrada_ultima_atividade_us();
+  if (ultima_serial_us > ultima)
+    ultima = ultima_serial_us;
+  return time_us_64() - ultima > REPOUSO_APOS_MS * 1000ull;
+}
+
+// Chamada a cada byte recebido pela serial: conta como uso, acordado ou não
+void repouso_uso_serial()
+{
+  ultima_serial_us = time_us_64();
+}
+
+// Chamada pelas interrupções (alarme, GPIO, serial). Retorna true se o
+// firmware estava dormindo: o toque que acorda o painel não vira comando.
+bool repouso_acordar(repouso_origem_t origem)
+{
+  if (!dormindo)
+    return false;
+  dormindo = false;
+  origem_despertar = origem;
+  despertar_us = time_us_32();
+  return true;
+}
+
+static void serial_disponivel(void *param)
+{
+  (void)param;
+  repouso_acordar(REPOUSO_SERIAL);
+}
+
+repouso_origem_t repouso_dormir()
+{
+  if (!app)
+    return REPOUSO_TIMER;
+  TRACE_BEGIN(TRACE_REPOUSO);
+  uint64_t inicio = time_us_64();
+
+  dormindo = true;
+  app->entrar();
+  dlog_estacionar(); // Telemetria, espelho e vigia do I2C param até o despertar
+  stdio_set_chars_available_callback(serial_disponivel, NULL);
+
+  uint32_t en0 = clocks_hw->sleep_en0, en1 = clocks_hw->sleep_en1;
+  clocks_hw->sleep_en0 = en0 & ~REPOUSO_SEM_CLOCK_EN0;
+  clocks_hw->sleep_en1 = en1 & ~REPOUSO_SEM_CLOCK_EN1;
+  scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+
+  // Com as interrupções mascaradas o WFI ainda acorda com uma pendente, e
+  // ela só é atendida depois do teste: nenhum despertar se perde entre os dois
+  uint32_t status = save_and_disable_interrupts();
+  while (dormindo)
+  {
+    __wfi();
+    restore_interrupts(status); // Atende a interrupção (alarme do núcleo 1, por exemplo)
+    status = save_and_disable_interrupts();
+  }
+  restore_interrupts(status);
+
+  scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+  clocks_hw->sleep_en0 = en0;
+  clocks_hw->sleep_en1 = en1;
+  stdio_set_chars_available_callback(NULL, NULL);
+  dlog_retomar();
+
+  repouso_origem_t origem = origem_despertar;
+  despertares[origem]++;
+  dormindo_total_us += time_us_64() - inicio;
+  if (origem == REPOUSO_SERIAL)
+    repouso_uso_serial();
+  aguardando_quadro = true;
+  app->sair();
+  TRACE_END(TRACE_REPOUSO);
+  return origem;
+}
+
+// Fim de um quadro enviado ao display: o primeiro após o despertar fecha a medição
+void repouso_quadro(uint32_t inicio_us)
+{
+  if (!aguardando_quadro || (int32_t)(inicio_us - despertar_us) < 0)
+    return;
+  aguardando_quadro = false;
+  uint32_t us = time_us_32() - despertar_us;
+  quadros++;
+  quadro_soma_us += us;
+  if (us > quadro_max_us)
+    quadro_max_us = us;
+}
+
+void repouso_relatorio()
+{
+  uint64_t total = time_us_64();
+  uint64_t dormindo_us = dormindo_total_us;
+  uint32_t permil = total ? dormindo_us * 1000 / total : 0;
+
+  // Média ponderada pelo tempo em cada estado, com as constantes de repouso.h
+  uint64_t acordado_ua = REPOUSO_UA_MCU_ACORDADO + REPOUSO_UA_OLED_LIGADO + REPOUSO_UA_LEDS_ACESOS;
+  uint64_t dormindo_ua = REPOUSO_UA_MCU_DORMINDO + REPOUSO_UA_OLED_DESLIGADO;
+  uint32_t media_ua = (acordado_ua * (1000 - permil) + dormindo_ua * permil) / 1000 + REPOUSO_UA_LEDS_QUIESCENTES;
+
+  printf("REPOUSO apos %u s sem uso\n", (unsigned)(REPOUSO_APOS_MS / 1000));
+  printf("  dormindo %lu.%lu%% do tempo; despertares:", (unsigned long)(permil / 10), (unsigned long)(permil % 10));
+  for (uint o = 0; o < REPOUSO_NUM_ORIGENS; o++)
+    printf(" %s=%lu", nomes[o], (unsigned long)despertares[o]);
+  printf("\n  despertar->quadro: n=%lu media=%lu ms max=%lu ms\n", (unsigned long)quadros,
+         (unsigned long)(quadros ? quadro_soma_us / quadros / 1000 : 0), (unsigned long)(quadro_max_us / 1000));
+  printf("  corrente media estimada: %lu.%lu mA (acordado %lu mA, dormindo %lu mA)\n", (unsigned long)(media_ua / 1000),
+         (unsigned long)(media_ua % 1000 / 100), (unsigned long)((acordado_ua + REPOUSO_UA_LEDS_QUIESCENTES) / 1000),
+         (unsigned long)((dormindo_ua + REPOUSO_UA_LEDS_QUIESCENTES) / 1000));
+}
@@ -0,0 +1,49 @@
+#ifndef REPOUSO_H
+#define REPOUSO_H
+
+#include "pico/stdlib.h"
+
+// Repouso entre alimentações: sem uso por REPOUSO_APOS_MS, o painel e a
+// matriz são apagados, o núcleo 1 é estacionado em WFE e o núcleo 0 dorme
+// em WFI, com os clocks de periféricos parados (SLEEP_EN), até o alarme do
+// modo automático, uma borda dos botões A/B/joystick ou dados na serial.
+//
+// O estado DORMANT do RP2040 para também o cristal e o temporizador: o
+// alarme do modo automático não dispararia sem um clock externo para o RTC,
+// e o USB cairia. Por isso o repouso usa o modo sleep.
+
+#ifndef REPOUSO_APOS_MS
+#define REPOUSO_APOS_MS 30000
+#endif
+
+// Consumo típico de cada parte (µA) para a estimativa de corrente média.
+// São valores de referência; calibre com um resistor shunt na alimentação.
+#define REPOUSO_UA_MCU_ACORDADO 18000   // RP2040 alternando 133/48 MHz, USB ativo
+#define REPOUSO_UA_MCU_DORMINDO 1500    // WFI/WFE nos dois núcleos a 48 MHz, periféricos sem clock
+#define REPOUSO_UA_OLED_LIGADO 10000    // SSD1306 com as telas do firmware
+#define REPOUSO_UA_OLED_DESLIGADO 10    // SET_DISP desligado
+#define REPOUSO_UA_LEDS_ACESOS 15000    // Barras de ração e água (brilho 0x26)
+#define REPOUSO_UA_LEDS_QUIESCENTES 17500 // 25 WS2812 mesmo apagados (~0,7 mA cada)
+
+typedef enum {
+  REPOUSO_TIMER,  // Alarme do modo automático
+  REPOUSO_BOTAO,  // Borda dos botões A, B ou do joystick
+  REPOUSO_SERIAL, // Dados recebidos pela serial
+  REPOUSO_NUM_ORIGENS
+} repouso_origem_t;
+
+// Ligação com a aplicação: apagar e religar painel e matriz
+typedef struct {
+  void (*entrar)();
+  void (*sair)();
+} repouso_app_t;
+
+void repouso_init(const repouso_app_t *app);
+bool repouso_ocioso();
+void repouso_uso_serial();
+repouso_origem_t repouso_dormir();
+bool repouso_acordar(repouso_origem_t origem);
+void repouso_quadro(uint32_t inicio_us);
+void repouso_relatorio();
+
+#endif
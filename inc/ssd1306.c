@@ -1,6 +1,8 @@
 #include "ssd1306.h"
 #include "font.h"
+#include "trace.h"
 #include <stdio.h>
+#include <string.h>
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c)
 {
   ssd->width = width;
@@ -12,6 +14,33 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->ao_enviar = NULL;
+  ssd->ao_atualizar = NULL;
+  ssd->barramento = NULL;
+}
+
+// Escreve uma transferência completa (byte de controle e o resto) e espera
+// o fim. Pelo gerenciador, o byte de controle se repete em cada bloco.
+static void escrever(ssd1306_t *ssd, const uint8_t *buf, size_t n)
+{
+  if (!ssd->barramento)
+  {
+    i2c_write_blocking(ssd->i2c_port, ssd->address, buf, n, false);
+    return;
+  }
+  barramento_transacao_t *t = &ssd->transacao;
+  *t = (barramento_transacao_t){.endereco = ssd->address, .prefixo = buf[0], .escrita = buf + 1,
+                                .n_escrita = n - 1, .prioridade = BARRAMENTO_BAIXA};
+  barramento_enviar(ssd->barramento, t);
+  barramento_aguardar(ssd->barramento, t);
+}
+
+// Janela de colunas e páginas das próximas escritas de dados, numa única
+// transferência de comandos
+static void enderecar(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1)
+{
+  uint8_t comandos[] = {0x00, SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p0, p1};
+  escrever(ssd, comandos, sizeof(comandos));
 }
 
 void ssd1306_config(ssd1306_t *ssd)
@@ -46,28 +75,44 @@ void ssd1306_config(ssd1306_t *ssd)
 void ssd1306_command(ssd1306_t *ssd, uint8_t command)
 {
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
-      ssd->i2c_port,
-      ssd->address,
-      ssd->port_buffer,
-      2,
-      false);
+  escrever(ssd, ssd->port_buffer, 2);
 }
 
 void ssd1306_send_data(ssd1306_t *ssd)
 {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-      ssd->i2c_port,
-      ssd->address,
-      ssd->ram_buffer,
-      ssd->bufsize,
-      false);
+  TRACE_BEGIN(TRACE_SSD1306_ENVIO);
+  uint32_t inicio_us = time_us_32();
+  enderecar(ssd, 0, ssd->width - 1, 0, ssd->pages - 1);
+  escrever(ssd, ssd->ram_buffer, ssd->bufsize);
+  TRACE_END(TRACE_SSD1306_ENVIO);
+  if (ssd->ao_atualizar)
+    ssd->ao_atualizar(ssd);
+  if (ssd->ao_enviar)
+    ssd->ao_enviar(ssd, inicio_us);
+}
+
+// Envia só as colunas x0..x1 das páginas p0..p1. No endereçamento vertical
+// o display recebe as páginas de cada coluna em sequência, a mesma ordem do
+// buffer; a janela é copiada para ficar contígua atrás do byte de controle.
+// Não chama ao_enviar: é uma atualização parcial, não um quadro novo.
+void ssd1306_send_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1)
+{
+  static uint8_t janela[WIDTH * HEIGHT / 8 + 1];
+  TRACE_BEGIN(TRACE_SSD1306_JANELA);
+  uint8_t paginas = p1 - p0 + 1;
+  size_t n = 0;
+  janela[n++] = 0x40;
+  for (uint8_t x = x0; x <= x1; x++)
+  {
+    memcpy(&janela[n], &ssd->ram_buffer[(x << 3) + 1 + p0], paginas);
+    n += paginas;
+  }
+
+  enderecar(ssd, x0, x1, p0, p1);
+  escrever(ssd, janela, n);
+  TRACE_END(TRACE_SSD1306_JANELA);
+  if (ssd->ao_atualizar)
+    ssd->ao_atualizar(ssd);
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value)
@@ -89,14 +134,8 @@ void ssd1306_fill(ssd1306_t *ssd, bool value) {
 
 void ssd1306_fill(ssd1306_t *ssd, bool value)
 {
-  // Itera por todas as posições do display
-  for (uint8_t y = 0; y < ssd->height; ++y)
-  {
-    for (uint8_t x = 0; x < ssd->width; ++x)
-    {
-      ssd1306_pixel(ssd, x, y, value);
-    }
-  }
+  // Preenche o buffer inteiro de uma vez (o byte 0 é o controle do I2C)
+  memset(ssd->ram_buffer + 1, value ? 0xFF : 0x00, ssd->bufsize - 1);
 }
 
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill)
@@ -169,11 +208,10 @@ void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value
     ssd1306_pixel(ssd, x, y, value);
 }
 
-// Função para desenhar um caractere
-void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
+// Retorna as 8 colunas do glifo de um caractere, ou NULL se não houver glifo
+static const uint8_t *ssd1306_glyph(char c)
 {
   uint16_t index = 0;
-  uint8_t espacamento = 1; // Define o espaçamento desejado (em pixels)
 
   // Calcula o índice do caractere na fonte
   if (c >= 'A' && c <= 'Z')
@@ -200,20 +238,42 @@ void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
     index = (c - '.'+ 76) * 8;
   }
   else
+  {
+    return NULL; // Caractere não suportado
+  }
+  return &font[index];
+}
+
+// Escreve 8 pixels verticais (bit 0 no topo) a partir de (x, y) direto no
+// buffer, que guarda as páginas de cada coluna em sequência
+static inline void ssd1306_blit_coluna(ssd1306_t *ssd, uint8_t x, uint8_t y, uint8_t bits)
+{
+  if (x >= ssd->width || y >= ssd->height)
+    return;
+  uint8_t *coluna = &ssd->ram_buffer[(x << 3) + 1];
+  uint8_t pagina = y >> 3;
+  uint8_t desloc = y & 7;
+
+  coluna[pagina] = (coluna[pagina] & (uint8_t)~(0xFF << desloc)) | (uint8_t)(bits << desloc);
+  if (desloc && pagina + 1 < ssd->pages)
+    coluna[pagina + 1] = (coluna[pagina + 1] & (uint8_t)~(0xFF >> (8 - desloc))) | (uint8_t)(bits >> (8 - desloc));
+}
+
+// Função para desenhar um caractere
+void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
+{
+  uint8_t espacamento = 1; // Define o espaçamento desejado (em pixels)
+  const uint8_t *glyph = ssd1306_glyph(c);
+
+  if (!glyph)
   {
     return; // Caractere não suportado
   }
 
-  // Desenha o caractere na tela (após o espaçamento)
+  // Desenha o caractere na tela (após o espaçamento), uma coluna por vez
   for (uint8_t i = 0; i < 8; ++i)
   {
-    uint8_t line = font[index + i]; // Lê a linha correspondente da fonte
-
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      // Desenha cada pixel do caractere
-      ssd1306_pixel(ssd, x + espacamento + i, y + j + 1, line & (1 << j));
-    }
+    ssd1306_blit_coluna(ssd, x + espacamento + i, y + 1, glyph[i]);
   }
 }
 
@@ -234,4 +294,103 @@ void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
       break;
     }
   }
-}
\ No newline at end of file
+}
+
+// Rasteriza um texto em colunas de 8 bits; caracteres sem glifo ficam
+// marcados em 'ausentes' para não apagarem o fundo, como em ssd1306_draw_char
+static uint8_t ssd1306_render(const char *str, uint8_t *colunas, uint8_t max, uint32_t *ausentes)
+{
+  uint8_t n = 0;
+  *ausentes = 0;
+  for (; str[n] && n < max; n++)
+  {
+    const uint8_t *glyph = ssd1306_glyph(str[n]);
+    if (glyph)
+      memcpy(&colunas[n * 8], glyph, 8);
+    else
+      *ausentes |= 1u << n;
+  }
+  return n;
+}
+
+// Copia colunas pré-renderizadas com o mesmo posicionamento de ssd1306_draw_string
+static void ssd1306_blit_texto(ssd1306_t *ssd, const uint8_t *colunas, uint8_t tamanho, uint32_t ausentes, uint8_t x, uint8_t y)
+{
+  for (uint8_t k = 0; k < tamanho; k++)
+  {
+    if (!(ausentes & (1u << k)))
+    {
+      for (uint8_t i = 0; i < 8; ++i)
+        ssd1306_blit_coluna(ssd, x + 1 + i, y + 1, colunas[k * 8 + i]);
+    }
+    x += 8;
+    if (x + 8 >= ssd->width)
+    {
+      x = 0;
+      y += 8;
+    }
+    if (y + 8 >= ssd->height)
+    {
+      break;
+    }
+  }
+}
+
+// Desenha um texto constante, rasterizado só no primeiro uso
+void ssd1306_draw_label(ssd1306_t *ssd, ssd1306_label_t *label, uint8_t x, uint8_t y)
+{
+  if (!label->colunas)
+  {
+    size_t tamanho = strlen(label->texto);
+    if (tamanho > SSD1306_LABEL_MAX || !(label->colunas = malloc(tamanho * 8)))
+    {
+      ssd1306_draw_string(ssd, label->texto, x, y); // Sem cache para textos longos
+      return;
+    }
+    label->tamanho = ssd1306_render(label->texto, label->colunas, tamanho, &label->ausentes);
+  }
+  ssd1306_blit_texto(ssd, label->colunas, label->tamanho, label->ausentes, x, y);
+}
+
+// Cache LRU para textos dinâmicos (ex.: "Racao: %d g"), indexado pelo conteúdo
+typedef struct {
+  char texto[SSD1306_CACHE_MAX + 1];
+  uint8_t colunas[SSD1306_CACHE_MAX * 8];
+  uint8_t tamanho;
+  uint32_t ausentes;
+  uint32_t uso; // Momento do último uso, para escolher quem sai
+} ssd1306_cache_t;
+
+static ssd1306_cache_t cache[SSD1306_CACHE_ENTRADAS];
+static uint32_t cache_relogio = 0;
+
+void ssd1306_draw_string_cached(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
+{
+  if (strlen(str) > SSD1306_CACHE_MAX)
+  {
+    ssd1306_draw_string(ssd, str, x, y);
+    return;
+  }
+
+  ssd1306_cache_t *e = NULL;
+  ssd1306_cache_t *antiga = &cache[0];
+  for (uint i = 0; i < SSD1306_CACHE_ENTRADAS; i++)
+  {
+    if (cache[i].uso && strcmp(cache[i].texto, str) == 0)
+    {
+      e = &cache[i];
+      break;
+    }
+    if (cache[i].uso < antiga->uso)
+      antiga = &cache[i];
+  }
+
+  if (!e)
+  {
+    e = antiga;
+    strcpy(e->texto, str);
+    e->tamanho = ssd1306_render(str, e->colunas, SSD1306_CACHE_MAX, &e->ausentes);
+  }
+  e->uso = ++cache_relogio;
+  ssd1306_blit_texto(ssd, e->colunas, e->tamanho, e->ausentes, x, y);
+}
@@ -1,6 +1,10 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "barramento.h"
 
 #define WIDTH 128
 #define HEIGHT 64
@@ -25,19 +29,42 @@ typedef enum {
   SET_CHARGE_PUMP = 0x8D
 } ssd1306_command_t;
 
-typedef struct {
+typedef struct ssd1306 {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
+  // Com um gerenciador, as escritas entram na fila de prioridade baixa e
+  // são divididas em blocos; sem ele, vão direto ao I2C
+  barramento_t *barramento;
+  barramento_transacao_t transacao;
+  // Chamado ao fim de cada ssd1306_send_data, com o instante em que o envio começou
+  void (*ao_enviar)(struct ssd1306 *ssd, uint32_t inicio_us);
+  // Chamado depois de cada envio de dados, quadro inteiro ou janela
+  void (*ao_atualizar)(struct ssd1306 *ssd);
 } ssd1306_t;
 
+#define SSD1306_LABEL_MAX 32      // Caracteres de um texto constante em cache
+#define SSD1306_CACHE_ENTRADAS 4  // Entradas do cache LRU de textos dinâmicos
+#define SSD1306_CACHE_MAX 16      // Caracteres de um texto dinâmico em cache
+
+// Texto constante rasterizado uma única vez, no primeiro desenho
+typedef struct {
+  const char *texto;
+  uint8_t *colunas;
+  uint8_t tamanho;
+  uint32_t ausentes;
+} ssd1306_label_t;
+
+#define SSD1306_LABEL(str) {(str), NULL, 0, 0}
+
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_send_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -46,4 +73,8 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
\ No newline at end of file
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+void ssd1306_draw_label(ssd1306_t *ssd, ssd1306_label_t *label, uint8_t x, uint8_t y);
+void ssd1306_draw_string_cached(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+
+#endif
@@ -0,0 +1,63 @@
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+#include "hardware/sync.h"
+#include <stdio.h>
+
+typedef struct {
+  trace_evento_t eventos[TRACE_TAM_FILA];
+  uint32_t cabeca;     // Total de eventos já gravados (escrito só pelo próprio núcleo)
+  uint32_t exportados; // Eventos já enviados por trace_exportar()
+} trace_fila_t;
+
+// Uma fila por núcleo: cada núcleo só escreve na sua, sem disputa entre eles
+static trace_fila_t filas[2];
+static volatile bool pausado = false;
+
+void trace_registrar(trace_tipo_t tipo, trace_id_t id, int32_t valor)
+{
+  if (pausado)
+    return;
+
+  trace_fila_t *f = &filas[get_core_num()];
+
+  // Interrupções do mesmo núcleo também gravam; mascara só durante a reserva
+  uint32_t status = save_and_disable_interrupts();
+  trace_evento_t *e = &f->eventos[f->cabeca++ & (TRACE_TAM_FILA - 1)];
+  e->tempo_us = time_us_32();
+  e->tipo = tipo;
+  e->id = id;
+  e->valor = valor;
+  restore_interrupts(status);
+}
+
+// Exporta as filas em texto pela serial. Formato de cada linha:
+//   T <núcleo> <tipo> <id> <tempo_us> <valor>
+// O tools/trace2json.py converte a captura para o formato de trace do Chrome.
+void trace_exportar()
+{
+  pausado = true;
+  printf("TRACE_INICIO\n");
+  for (uint n = 0; n < 2; n++)
+  {
+    trace_fila_t *f = &filas[n];
+    uint32_t total = f->cabeca;
+    uint32_t inicio = f->exportados;
+    if (total - inicio > TRACE_TAM_FILA)
+    {
+      printf("TRACE_SOBRESCRITOS %u %lu\n", n, (unsigned long)(total - inicio - TRACE_TAM_FILA));
+      inicio = total - TRACE_TAM_FILA;
+    }
+    for (uint32_t i = inicio; i < total; i++)
+    {
+      trace_evento_t *e = &f->eventos[i & (TRACE_TAM_FILA - 1)];
+      printf("T %u %c %u %lu %ld\n", n, e->tipo, e->id, (unsigned long)e->tempo_us, (long)e->valor);
+    }
+    f->exportados = total;
+  }
+  printf("TRACE_FIM\n");
+  pausado = false;
+}
+
+#endif
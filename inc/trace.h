@@ -0,0 +1,50 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Rastreamento de trechos críticos. Com TRACE_ENABLED=0 (padrão) todas as
+// macros e funções somem da compilação.
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+#include "trace_ids.h"
+
+#if TRACE_ENABLED
+
+#include "pico/stdlib.h"
+
+#define TRACE_TAM_FILA 512 // Eventos por núcleo (potência de 2); os mais antigos são sobrescritos
+
+typedef enum {
+  TRACE_TIPO_INICIO = 'B',
+  TRACE_TIPO_FIM = 'E',
+  TRACE_TIPO_CONTADOR = 'C',
+  TRACE_TIPO_INSTANTE = 'i'
+} trace_tipo_t;
+
+typedef struct {
+  uint32_t tempo_us; // Timer do RP2040 (1 MHz, comum aos dois núcleos)
+  uint8_t tipo;
+  uint8_t id;
+  int32_t valor;
+} trace_evento_t;
+
+void trace_registrar(trace_tipo_t tipo, trace_id_t id, int32_t valor);
+void trace_exportar();
+
+#define TRACE_BEGIN(id) trace_registrar(TRACE_TIPO_INICIO, (id), 0)
+#define TRACE_END(id) trace_registrar(TRACE_TIPO_FIM, (id), 0)
+#define TRACE_COUNTER(id, v) trace_registrar(TRACE_TIPO_CONTADOR, (id), (v))
+#define TRACE_INSTANT(id) trace_registrar(TRACE_TIPO_INSTANTE, (id), 0)
+
+#else
+
+#define TRACE_BEGIN(id) ((void)0)
+#define TRACE_END(id) ((void)0)
+#define TRACE_COUNTER(id, v) ((void)0)
+#define TRACE_INSTANT(id) ((void)0)
+#define trace_exportar() ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef TRACE_IDS_H
+#define TRACE_IDS_H
+
+// Pontos de rastreamento: X(id, "nome"). O tools/trace2json.py lê este
+// arquivo para nomear os eventos; novos ids entram sempre no final.
+#define TRACE_IDS(X)                              \
+  X(TRACE_LOOP, "loop")                           \
+  X(TRACE_SSD1306_ENVIO, "ssd1306_send_data")     \
+  X(TRACE_LEDS, "atualizar_leds")                 \
+  X(TRACE_DESPEJAR, "despejar")                   \
+  X(TRACE_IRQ_GPIO, "irq_gpio")                   \
+  X(TRACE_IRQ_TIMER, "irq_timer")                 \
+  X(TRACE_JITTER_TIMER_US, "jitter_timer_us")     \
+  X(TRACE_DLOG_DRENAR, "dlog_drenar")             \
+  X(TRACE_GOVERNADOR, "governador")               \
+  X(TRACE_REPOUSO, "repouso")                     \
+  X(TRACE_BARRAS, "atualizar_barras")             \
+  X(TRACE_SSD1306_JANELA, "ssd1306_send_window")  \
+  X(TRACE_GRAFICO, "grafico_avancar")             \
+  X(TRACE_BITMAP, "bitmap_desenhar")              \
+  X(TRACE_JITTER_GPIO_US, "jitter_gpio_us")
+
+#define TRACE_ID(id, nome) id,
+typedef enum {
+  TRACE_IDS(TRACE_ID)
+  TRACE_NUM_IDS
+} trace_id_t;
+#undef TRACE_ID
+
+#endif
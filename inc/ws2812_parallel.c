@@ -0,0 +1,136 @@
+#include "ws2812_parallel.h"
+#include "ws2812.pio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Tempo de reset (linha em nível baixo) exigido pelo WS2812 entre quadros
+#define WS2812_RESET_US 60
+
+// Divisor do PIO em ponto fixo 16.8 para 'freq' bits/s no clk_sys atual
+static uint32_t divisor(uint32_t freq)
+{
+  uint32_t hz = clock_get_hz(clk_sys);
+  uint32_t alvo = freq * (ws2812_parallel_T1 + ws2812_parallel_T2 + ws2812_parallel_T3);
+#if PERFIL_INTEIRO
+  return hz / alvo << 8 | hz % alvo * 256 / alvo;
+#else
+  return (uint32_t)(hz / (float)alvo * 256.0f);
+#endif
+}
+
+void ws2812_parallel_init(ws2812_parallel_t *ws, PIO pio, uint pin_base, uint num_fitas, uint num_pixels, uint32_t freq)
+{
+  ws->pio = pio;
+  ws->sm = pio_claim_unused_sm(pio, true);
+  ws->offset = pio_add_program(pio, &ws2812_parallel_program);
+  ws->pin_base = pin_base;
+  ws->num_fitas = num_fitas > WS2812_PARALLEL_MAX_FITAS ? WS2812_PARALLEL_MAX_FITAS : num_fitas;
+  ws->num_pixels = num_pixels;
+  ws->freq = freq;
+  ws->num_palavras = num_pixels * WS2812_PARALLEL_BITS_PIXEL;
+  ws->planos = calloc(ws->num_palavras, sizeof(uint32_t));
+  ws->livre_em = get_absolute_time();
+
+  ws2812_parallel_program_init(pio, ws->sm, ws->offset, pin_base, ws->num_fitas, divisor(freq));
+
+  // DMA alimenta a FIFO do PIO com os planos de bits, no ritmo do DREQ
+  ws->dma_chan = dma_claim_unused_channel(true);
+  dma_channel_config c = dma_channel_get_default_config(ws->dma_chan);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, pio_get_dreq(pio, ws->sm, true));
+  dma_channel_configure(ws->dma_chan, &c, &pio->txf[ws->sm], ws->planos, ws->num_palavras, false);
+}
+
+// Transpõe uma matriz de 8x8 bits (Hacker's Delight, transpose8).
+// Entrada: linhas A0..A3 em x e A4..A7 em y, com A0 no byte mais alto.
+static inline void transpor8(uint32_t *x, uint32_t *y)
+{
+  uint32_t t;
+  t = (*x ^ (*x >> 7)) & 0x00AA00AA;
+  *x = *x ^ t ^ (t << 7);
+  t = (*y ^ (*y >> 7)) & 0x00AA00AA;
+  *y = *y ^ t ^ (t << 7);
+  t = (*x ^ (*x >> 14)) & 0x0000CCCC;
+  *x = *x ^ t ^ (t << 14);
+  t = (*y ^ (*y >> 14)) & 0x0000CCCC;
+  *y = *y ^ t ^ (t << 14);
+  t = (*x & 0xF0F0F0F0) | ((*y >> 4) & 0x0F0F0F0F);
+  *y = ((*x << 4) & 0xF0F0F0F0) | (*y & 0x0F0F0F0F);
+  *x = t;
+}
+
+// Converte os buffers de cada fita em planos de bits.
+// Para cada pixel, o plano b guarda o bit (31 - b) de todas as fitas,
+// com a fita s no bit s da palavra (pino pin_base + s).
+void ws2812_parallel_pack(ws2812_parallel_t *ws, const uint32_t *const fitas[])
+{
+  ws2812_parallel_wait(ws); // Não altera os planos enquanto o DMA os lê
+  memset(ws->planos, 0, ws->num_palavras * sizeof(uint32_t));
+
+  for (uint g = 0; g * 8 < ws->num_fitas; g++)
+  {
+    uint base = g * 8;
+    for (uint p = 0; p < ws->num_pixels; p++)
+    {
+      // Lê o pixel p das 8 fitas do grupo (fitas inexistentes valem 0)
+      uint32_t px[8];
+      for (uint i = 0; i < 8; i++)
+      {
+        uint s = base + 7 - i;
+        px[i] = s < ws->num_fitas ? fitas[s][p] : 0;
+      }
+
+      uint32_t *plano = &ws->planos[p * WS2812_PARALLEL_BITS_PIXEL];
+      for (uint k = 0; k < 3; k++)
+      {
+        uint desloc = 24 - 8 * k; // Byte G, R e B, nessa ordem
+        uint32_t x = ((px[0] >> desloc) & 0xFF) << 24 | ((px[1] >> desloc) & 0xFF) << 16 |
+                     ((px[2] >> desloc) & 0xFF) << 8 | ((px[3] >> desloc) & 0xFF);
+        uint32_t y = ((px[4] >> desloc) & 0xFF) << 24 | ((px[5] >> desloc) & 0xFF) << 16 |
+                     ((px[6] >> desloc) & 0xFF) << 8 | ((px[7] >> desloc) & 0xFF);
+        transpor8(&x, &y);
+
+        for (uint j = 0; j < 4; j++)
+        {
+          plano[8 * k + j] |= ((x >> (24 - 8 * j)) & 0xFF) << base;
+          plano[8 * k + 4 + j] |= ((y >> (24 - 8 * j)) & 0xFF) << base;
+        }
+      }
+    }
+  }
+}
+
+// Inicia o envio dos planos por DMA e retorna imediatamente
+void ws2812_parallel_show(ws2812_parallel_t *ws)
+{
+  ws2812_parallel_wait(ws);
+  dma_channel_transfer_from_buffer_now(ws->dma_chan, ws->planos, ws->num_palavras);
+
+  // O DMA termina antes do PIO; a fita só fica livre após o último bit e o reset
+  uint32_t duracao_us = (uint32_t)((uint64_t)ws->num_palavras * 1000000u / ws->freq);
+  ws->livre_em = make_timeout_time_us(duracao_us + WS2812_RESET_US);
+}
+
+bool ws2812_parallel_busy(ws2812_parallel_t *ws)
+{
+  return dma_channel_is_busy(ws->dma_chan) || !time_reached(ws->livre_em);
+}
+
+void ws2812_parallel_wait(ws2812_parallel_t *ws)
+{
+  dma_channel_wait_for_finish_blocking(ws->dma_chan);
+  while (!time_reached(ws->livre_em))
+    tight_loop_contents();
+}
+
+// Recalcula o divisor do PIO para o clk_sys atual (após uma troca de clock)
+void ws2812_parallel_retemporizar(ws2812_parallel_t *ws)
+{
+  ws2812_parallel_wait(ws);
+  uint32_t div = divisor(ws->freq);
+  pio_sm_set_clkdiv_int_frac(ws->pio, ws->sm, div >> 8, div & 0xFF);
+}
@@ -0,0 +1,35 @@
+#ifndef WS2812_PARALLEL_H
+#define WS2812_PARALLEL_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+// Bits transmitidos por pixel (GRB, 8 bits por cor)
+#define WS2812_PARALLEL_BITS_PIXEL 24
+// Máximo de fitas: uma por bit da palavra enviada ao PIO
+#define WS2812_PARALLEL_MAX_FITAS 32
+
+// Driver para várias fitas/matrizes WS2812 em pinos consecutivos.
+// Os pixels de cada fita usam o mesmo formato do programa ws2812
+// (0xGGRRBB00) e são transpostos em planos de bits: cada palavra
+// enviada ao PIO contém um bit de cada fita, então todas as fitas
+// são atualizadas ao mesmo tempo por uma única state machine via DMA.
+typedef struct {
+  PIO pio;
+  uint sm, offset;
+  uint pin_base, num_fitas, num_pixels;
+  uint32_t freq; // Bits por segundo em cada fita
+  int dma_chan;
+  uint32_t *planos;
+  size_t num_palavras;
+  absolute_time_t livre_em;
+} ws2812_parallel_t;
+
+void ws2812_parallel_init(ws2812_parallel_t *ws, PIO pio, uint pin_base, uint num_fitas, uint num_pixels, uint32_t freq);
+void ws2812_parallel_pack(ws2812_parallel_t *ws, const uint32_t *const fitas[]);
+void ws2812_parallel_show(ws2812_parallel_t *ws);
+bool ws2812_parallel_busy(ws2812_parallel_t *ws);
+void ws2812_parallel_wait(ws2812_parallel_t *ws);
+void ws2812_parallel_retemporizar(ws2812_parallel_t *ws);
+
+#endif
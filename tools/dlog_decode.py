@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""Decodifica o fluxo binário do log diferido (firmware com DLOG_BINARIO=1).
+
+Uso:
+    python3 tools/dlog_decode.py /dev/ttyACM0      # porta serial (requer pyserial)
+    python3 tools/dlog_decode.py captura.bin       # arquivo capturado
+    cat captura.bin | python3 tools/dlog_decode.py -
+
+Os formatos são lidos de inc/dlog_fmt.h, então o decodificador acompanha
+a tabela do firmware. Bytes fora de um registro válido (texto de outras
+saídas, ruído) são ignorados até o próximo byte de sincronismo.
+"""
+import os
+import re
+import struct
+import sys
+
+SINC = 0xD5
+REGISTRO = struct.Struct("<IBBHii")  # tempo_us, id, nargs, seq, args[2]
+RAIZ = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def carregar_formatos(caminho=os.path.join(RAIZ, "inc", "dlog_fmt.h")):
+    with open(caminho, encoding="utf-8") as f:
+        return re.findall(r'X\(\s*DLOG_\w+\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', f.read())
+
+
+def abrir(origem):
+    if origem == "-":
+        return sys.stdin.buffer
+    if origem.startswith("/dev/") or origem.upper().startswith("COM"):
+        import serial  # pyserial
+
+        return serial.Serial(origem, 115200)
+    return open(origem, "rb")
+
+
+def registros(fluxo):
+    """Gera (tempo_us, id, seq, args) para cada registro válido do fluxo."""
+    buf = bytearray()
+    tam = REGISTRO.size + 2
+    while True:
+        dados = fluxo.read(1) if hasattr(fluxo, "in_waiting") else fluxo.read(4096)
+        if not dados:
+            break
+        buf += dados
+        while True:
+            i = buf.find(SINC)
+            if i < 0:
+                buf.clear()
+                break
+            del buf[:i]
+            if len(buf) < tam:
+                break
+            corpo = bytes(buf[1 : 1 + REGISTRO.size])
+            if sum(corpo) & 0xFF != buf[tam - 1]:
+                del buf[:1]  # Sincronismo falso: procura o próximo
+                continue
+            del buf[:tam]
+            tempo, ident, nargs, seq, a, b = REGISTRO.unpack(corpo)
+            yield tempo, ident, seq, (a, b)[:nargs]
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__, file=sys.stderr)
+        return 2
+    formatos = carregar_formatos()
+    ultimo_seq = None
+    for tempo, ident, seq, args in registros(abrir(sys.argv[1])):
+        if ident != 0:  # O registro de descartes não consome sequência
+            if ultimo_seq is not None and seq != (ultimo_seq + 1) & 0xFFFF:
+                print("[dlog] sequencia %d -> %d (registros faltando)" % (ultimo_seq, seq))
+            ultimo_seq = seq
+        fmt = formatos[ident] if ident < len(formatos) else "[dlog] id desconhecido %d" % ident
+        try:
+            texto = fmt % args
+        except TypeError:
+            texto = "%s %r" % (fmt, args)
+        print("%10.3f ms  %s" % (tempo / 1000.0, texto), flush=True)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
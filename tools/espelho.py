@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+"""Visualizador do espelho do display (inc/espelho.h).
+
+Uso com a placa (requer pyserial):
+    python3 tools/espelho.py /dev/ttyACM0 [bytes/s]
+
+Com o simulador do host (host/), numa sessão sintética de latência:
+    python3 tools/espelho.py --simulador build_host/simulador [segundos] [bytes/s]
+
+Teste contra o simulador (alvo verificar_espelho):
+    python3 tools/espelho.py --testar-simulador build_host/simulador
+
+Liga o espelho com um pedido PROTOCOLO_ESPELHO (padrão 2000 bytes/s),
+aplica as diferenças recebidas e desenha no terminal cada quadro fechado
+com o hash conferido, dois pixels por caractere. Se o hash não bater
+(byte perdido na serial), pede o espelho de novo, o que reenvia a tela
+inteira. Com --salvar <dir>, grava cada quadro como PBM. Na placa, Ctrl+C
+desliga o espelho e sai.
+"""
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+from protocolo import RESPOSTA, Leitor, quadro
+
+ESPELHO, DADOS, QUADRO = 0x06, 0x91, 0x92
+LARGURA, PAGINAS = 128, 8
+BYTES = LARGURA * PAGINAS
+PADRAO = 2000
+ESPELHO_MIN = 200  # ESPELHO_ORCAMENTO_MIN
+
+
+def fnv(dados):
+    h = 2166136261
+    for b in dados:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def pedido(seq, bytes_s):
+    return quadro(ESPELHO, seq, struct.pack("<H", bytes_s))
+
+
+class Espelho:
+    """Reconstrói o buffer do display a partir dos quadros do espelho."""
+
+    def __init__(self):
+        self.buf = bytearray(BYTES)
+        self.ligado = False
+        self.divergencias = 0
+        self.bytes = 0
+
+    def aplicar(self, tipo, payload):
+        """Devolve (captura, tela) quando um quadro fecha com o hash certo.
+        Depois de uma divergência, self.ligado fica False até o próximo OK."""
+        if tipo == ESPELHO | RESPOSTA:
+            if payload[0] != 0:
+                raise SystemExit("espelho recusado: status %d" % payload[0])
+            self.buf = bytearray(BYTES)  # O firmware recomeça da tela apagada
+            self.ligado = True
+            return None
+        if tipo not in (DADOS, QUADRO):
+            return None
+        self.bytes += len(payload) + 6
+        if not self.ligado:
+            return None
+        if tipo == DADOS and self.dados(payload):
+            return None
+        if tipo == QUADRO:
+            captura, h = struct.unpack("<II", payload)
+            if fnv(self.buf) == h:
+                return captura, bytes(self.buf)
+        self.divergencias += 1
+        self.ligado = False
+        return None
+
+    def dados(self, payload):
+        i, j = payload[0] | payload[1] << 8, 2
+        while j < len(payload):
+            c = payload[j]
+            j += 1
+            if c < 0x80:
+                n = c + 1
+                trecho = payload[j : j + n]
+                j += n
+            elif c < 0xC0:
+                n = (c & 0x3F) + 2
+                trecho = payload[j : j + 1] * n
+                j += 1
+            else:
+                i += (c & 0x3F) + 1
+                continue
+            if i + n > BYTES or len(trecho) != n:
+                return False
+            self.buf[i : i + n] = trecho
+            i += n
+        return i <= BYTES
+
+
+def pixel(tela, x, y):
+    return tela[x * PAGINAS + y // 8] >> (y % 8) & 1
+
+
+def desenhar(tela):
+    linhas = []
+    for y in range(0, PAGINAS * 8, 2):
+        linhas.append("".join(" ▀▄█"[pixel(tela, x, y) | pixel(tela, x, y + 1) << 1] for x in range(LARGURA)))
+    return "\n".join(linhas)
+
+
+def salvar_pbm(diretorio, captura, tela):
+    with open(os.path.join(diretorio, "quadro_%06d.pbm" % captura), "w") as f:
+        f.write("P1\n%d %d\n" % (LARGURA, PAGINAS * 8))
+        for y in range(PAGINAS * 8):
+            f.write(" ".join(str(pixel(tela, x, y)) for x in range(LARGURA)) + "\n")
+
+
+def mostrar(captura, tela, espelho, salvar):
+    sys.stdout.write("\x1b[H\x1b[2J" + desenhar(tela) + "\ncaptura %d, %d bytes recebidos, %d divergencias\n"
+                     % (captura, espelho.bytes, espelho.divergencias))
+    sys.stdout.flush()
+    if salvar:
+        salvar_pbm(salvar, captura, tela)
+
+
+def executar(porta, bytes_s, salvar):
+    import serial  # pyserial
+
+    s = serial.Serial(porta, 115200, timeout=0.2)
+    leitor, espelho, seq = Leitor(), Espelho(), 1
+    s.write(pedido(seq, bytes_s))
+    try:
+        while True:
+            for tipo, _, payload in leitor.alimentar(s.read(256)):
+                ligado = espelho.ligado
+                r = espelho.aplicar(tipo, payload)
+                if r:
+                    mostrar(*r, espelho, salvar)
+                elif ligado and not espelho.ligado:
+                    seq = (seq + 1) & 0xFF
+                    s.write(pedido(seq, bytes_s))  # Divergiu: tela inteira de novo
+    except KeyboardInterrupt:
+        s.write(pedido(seq + 1, 0))
+        return 0
+
+
+def sessao_simulador(simulador, segundos, bytes_s, d, extras=()):
+    """Roda o simulador com o espelho ligado aos 0,5 s (0: sem pedido) e devolve a saída."""
+    args = [simulador, "latencia", str(segundos)] + list(extras)
+    if bytes_s:
+        caminho = os.path.join(d, "espelho.bin")
+        with open(caminho, "wb") as f:
+            f.write(pedido(1, bytes_s))
+        args += ["--serial", "0.5", caminho]
+    return subprocess.run(args, stdout=subprocess.PIPE, check=True).stdout
+
+
+def quadros_simulador(simulador, segundos, bytes_s):
+    """Saída do simulador e as linhas 'tempo hash' de cada quadro do display."""
+    with tempfile.TemporaryDirectory() as d:
+        arquivo = os.path.join(d, "quadros.txt")
+        saida = sessao_simulador(simulador, segundos, bytes_s, d, ["--quadros", arquivo])
+        with open(arquivo) as f:
+            return saida, f.read().split("\n")
+
+
+def simular(simulador, segundos, bytes_s, salvar):
+    espelho, quadros = Espelho(), 0
+    with tempfile.TemporaryDirectory() as d:
+        saida = sessao_simulador(simulador, segundos, bytes_s, d)
+    for tipo, _, payload in Leitor().alimentar(saida):
+        r = espelho.aplicar(tipo, payload)
+        if r:
+            mostrar(*r, espelho, salvar)
+            quadros += 1
+    print("%d quadros espelhados em %d s" % (quadros, segundos))
+    return 0
+
+
+def testar_simulador(simulador):
+    """Confere o espelho contra os quadros que o simulador mostrou no display."""
+    segundos = 60
+    falhas = []
+    _, base = quadros_simulador(simulador, segundos, 0)
+    for bytes_s in (PADRAO, ESPELHO_MIN):
+        saida, linhas = quadros_simulador(simulador, segundos, bytes_s)
+        mostrados = [int(linha.split()[1], 16) for linha in linhas if linha]
+
+        espelho, espelhados = Espelho(), []
+        for tipo, _, payload in Leitor().alimentar(saida):
+            r = espelho.aplicar(tipo, payload)
+            if r:
+                espelhados.append(fnv(r[1]))
+
+        def conferir(cond, msg):
+            if not cond:
+                falhas.append("%d bytes/s: %s" % (bytes_s, msg))
+
+        # O espelho não muda nada no display (mesmos quadros nos mesmos
+        # instantes que sem ele); todo quadro espelhado foi de fato mostrado,
+        # na ordem; o orçamento é respeitado, com folga para a rajada
+        # inicial; com o orçamento padrão o último quadro chega ao
+        # visualizador, com o mínimo alguns são pulados
+        conferir(linhas == base, "quadros do display diferentes dos sem espelho")
+        conferir(espelho.divergencias == 0, "%d divergencias" % espelho.divergencias)
+        conferir(len(espelhados) >= 5, "so %d quadros espelhados" % len(espelhados))
+        pos = 0
+        for h in espelhados:
+            while pos < len(mostrados) and mostrados[pos] != h:
+                pos += 1
+            conferir(pos < len(mostrados), "quadro %08x nunca mostrado" % h)
+        if bytes_s == PADRAO:
+            conferir(espelhados[-1:] == mostrados[-1:], "ultimo quadro nao espelhado")
+        limite = bytes_s * (segundos - 0.5) + 70
+        conferir(espelho.bytes <= limite, "%d bytes, limite %d" % (espelho.bytes, limite))
+        print("espelho %d bytes/s: %d de %d quadros, %d bytes (%d bytes/s)" % (
+            bytes_s, len(espelhados), len(mostrados), espelho.bytes, espelho.bytes / (segundos - 0.5)))
+
+    for f in falhas:
+        print("FALHA:", f)
+    print("espelho: %s" % ("FALHOU" if falhas else "OK"))
+    return 1 if falhas else 0
+
+
+def main():
+    args = sys.argv[1:]
+    salvar = None
+    if "--salvar" in args:
+        i = args.index("--salvar")
+        salvar = args[i + 1]
+        del args[i : i + 2]
+        os.makedirs(salvar, exist_ok=True)
+    if len(args) == 2 and args[0] == "--testar-simulador":
+        return testar_simulador(args[1])
+    if len(args) >= 2 and args[0] == "--simulador":
+        segundos = int(args[2]) if len(args) > 2 else 60
+        return simular(args[1], segundos, int(args[3]) if len(args) > 3 else PADRAO, salvar)
+    if len(args) in (1, 2) and not args[0].startswith("-"):
+        return executar(args[0], int(args[1]) if len(args) > 1 else PADRAO, salvar)
+    print(__doc__, file=sys.stderr)
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""Converte os desenhos de assets/ em bitmaps RLE const para a flash.
+
+Uso (chamado pelo CMake a cada mudança em assets/):
+    python3 tools/gerar_bitmaps.py <dir_saida> assets/icones.txt assets/digitos.txt
+
+Cada arquivo tem blocos "= nome" seguidos das linhas do desenho ('#'
+aceso, '.' apagado); linhas começando com '#' seguido de espaço são
+comentários. Gera em <dir_saida>:
+    bitmaps_gerados.h  enum BITMAP_<NOME>, BITMAP_NUM e BITMAP_LARGURA_MAX
+    bitmaps_gerados.c  tabela bitmaps[] (inc/bitmap.h) e os dados (RLE ou crus)
+
+Os pixels são empacotados em páginas como no SSD1306: um byte por coluna
+e página (bit 0 no topo), página por página, o que junta os bytes iguais
+de colunas vizinhas (traços verticais, bordas). A sequência é comprimida
+em RLE:
+    0x00-0x7F  literal: seguem c + 1 bytes
+    0x80-0xFF  repetição: o próximo byte vale (c & 0x7F) + 2 vezes
+Um bitmap em que o RLE não ganha nada fica com os bytes crus. O
+inc/bitmap.c descomprime direto no buffer do display, sem montar o bitmap
+na RAM. Imprime o tamanho de cada bitmap, bruto e na flash.
+"""
+import os
+import sys
+
+MAX_LITERAL = 128
+MAX_REPETICAO = 129
+
+
+def ler(caminho):
+    bitmaps = []
+    with open(caminho, encoding="utf-8") as f:
+        for num, linha in enumerate(f, 1):
+            linha = linha.rstrip("\n").rstrip()
+            if not linha or linha.startswith("# ") or linha == "#":
+                continue
+            if linha.startswith("= "):
+                bitmaps.append((linha[2:].strip(), []))
+                continue
+            if not bitmaps or set(linha) - set("#."):
+                sys.exit("%s:%d: linha inválida: %r" % (caminho, num, linha))
+            linhas = bitmaps[-1][1]
+            if linhas and len(linha) != len(linhas[0]):
+                sys.exit("%s:%d: largura %d, esperado %d" % (caminho, num, len(linha), len(linhas[0])))
+            linhas.append(linha)
+    for nome, linhas in bitmaps:
+        if not linhas or len(linhas[0]) > 255 or len(linhas) > 64:
+            sys.exit("%s: bitmap %s vazio ou grande demais" % (caminho, nome))
+    return bitmaps
+
+
+def empacotar(linhas):
+    largura, altura = len(linhas[0]), len(linhas)
+    paginas = (altura + 7) // 8
+    dados = []
+    for p in range(paginas):
+        for x in range(largura):
+            byte = 0
+            for b in range(8):
+                y = p * 8 + b
+                if y < altura and linhas[y][x] == "#":
+                    byte |= 1 << b
+            dados.append(byte)
+    return dados
+
+
+def comprimir(dados):
+    saida, literal = [], []
+
+    def fechar_literal():
+        while literal:
+            trecho = literal[:MAX_LITERAL]
+            del literal[:MAX_LITERAL]
+            saida.append(len(trecho) - 1)
+            saida.extend(trecho)
+
+    i = 0
+    while i < len(dados):
+        n = 1
+        while i + n < len(dados) and dados[i + n] == dados[i] and n < MAX_REPETICAO:
+            n += 1
+        # Duas repetições só compensam se não quebrarem um literal
+        if n >= 3 or (n == 2 and not literal):
+            fechar_literal()
+            saida += [0x80 | (n - 2), dados[i]]
+            i += n
+        else:
+            literal.append(dados[i])
+            i += 1
+    fechar_literal()
+    return saida
+
+
+def descomprimir(rle):
+    saida, i = [], 0
+    while i < len(rle):
+        c = rle[i]
+        if c & 0x80:
+            saida += [rle[i + 1]] * ((c & 0x7F) + 2)
+            i += 2
+        else:
+            saida += rle[i + 1 : i + 2 + c]
+            i += 2 + c
+    return saida
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__, file=sys.stderr)
+        return 2
+    saida = sys.argv[1]
+    bitmaps = []
+    for caminho in sys.argv[2:]:
+        bitmaps += ler(caminho)
+    nomes = [nome for nome, _ in bitmaps]
+    if len(set(nomes)) != len(nomes):
+        sys.exit("nomes de bitmap repetidos")
+
+    tabela = []
+    for nome, linhas in bitmaps:
+        bruto = empacotar(linhas)
+        rle = comprimir(bruto)
+        assert descomprimir(rle) == bruto, nome
+        if len(rle) < len(bruto):
+            tabela.append((nome, len(linhas[0]), len(linhas), bruto, rle, True))
+        else:
+            tabela.append((nome, len(linhas[0]), len(linhas), bruto, bruto, False))
+
+    total_bruto = sum(len(t[3]) for t in tabela)
+    total_flash = sum(len(t[4]) for t in tabela)
+    relatorio = ["%-10s %3dx%-2d %4d -> %4d bytes%s" % (n, l, a, len(b), len(d), "" if c else " (cru)")
+                 for n, l, a, b, d, c in tabela]
+    relatorio.append("total      %2d bitmaps %4d -> %4d bytes (%d%%)" %
+                     (len(tabela), total_bruto, total_flash, 100 * total_flash // max(total_bruto, 1)))
+
+    with open(os.path.join(saida, "bitmaps_gerados.h"), "w") as f:
+        f.write("// Gerado por tools/gerar_bitmaps.py a partir de assets/; não editar\n")
+        f.write("#ifndef BITMAPS_GERADOS_H\n#define BITMAPS_GERADOS_H\n\n")
+        f.write("typedef enum {\n")
+        for nome, *_ in tabela:
+            f.write("  BITMAP_%s,\n" % nome.upper())
+        f.write("  BITMAP_NUM\n} bitmap_id_t;\n\n")
+        f.write("#define BITMAP_LARGURA_MAX %d\n" % max(t[1] for t in tabela))
+        f.write("#define BITMAP_BYTES_BRUTOS %d\n" % total_bruto)
+        f.write("#define BITMAP_BYTES_FLASH %d\n\n#endif\n" % total_flash)
+
+    with open(os.path.join(saida, "bitmaps_gerados.c"), "w") as f:
+        f.write("// Gerado por tools/gerar_bitmaps.py a partir de assets/; não editar\n//\n")
+        for linha in relatorio:
+            f.write("// %s\n" % linha)
+        f.write('\n#include "inc/bitmap.h"\n\n')
+        for nome, _, _, _, dados, _ in tabela:
+            f.write("static const uint8_t dados_%s[%d] = {" % (nome, len(dados)))
+            for i, byte in enumerate(dados):
+                f.write(("\n  " if i % 16 == 0 else " ") + "0x%02X," % byte)
+            f.write("\n};\n\n")
+        f.write("const bitmap_t bitmaps[BITMAP_NUM] = {\n")
+        for nome, largura, altura, _, dados, rle in tabela:
+            f.write('  [BITMAP_%s] = {"%s", %d, %d, %s, %d, dados_%s},\n' %
+                    (nome.upper(), nome, largura, altura, "true" if rle else "false", len(dados), nome))
+        f.write("};\n")
+
+    print("\n".join(relatorio))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
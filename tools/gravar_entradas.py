@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""Captura a gravação de entradas do firmware para replay no simulador.
+
+Uso:
+    python3 tools/gravar_entradas.py /dev/ttyACM0 sessao.bin   # requer pyserial
+    python3 tools/gravar_entradas.py captura.txt sessao.bin    # converte um log salvo
+
+Com uma porta serial, envia o comando 'R' a cada segundo e acrescenta os
+blocos exportados ao arquivo até Ctrl-C. Os tempos da gravação são
+relativos ao registro anterior, então os blocos formam uma sessão
+contínua desde o boot; conecte antes da gravação em RAM encher.
+
+Reproduza com: build_host/simulador replay sessao.bin --quadros quadros.txt
+
+Teste da gravação e do replay no simulador (alvo verificar_gravacao):
+    python3 tools/gravar_entradas.py --testar-simulador build_host/simulador
+"""
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+CABECALHO = b"RPL1"
+TIPOS = {0: "GPIO_BAIXO", 1: "GPIO_ALTO", 2: "ADC"}
+BOTAO_A = 5
+
+
+def registros(dados):
+    """Gera (tempo_us desde o boot, tipo, canal, valor) de uma gravação sem o
+    cabeçalho (formato em inc/entrada.h)."""
+    i, t = 0, 0
+    while i < len(dados):
+        tipo, canal = dados[i] >> 6, dados[i] & 0x3F
+        i += 1
+        dt, desloc = 0, 0
+        while True:
+            b = dados[i]
+            i += 1
+            dt |= (b & 0x7F) << desloc
+            desloc += 7
+            if not b & 0x80:
+                break
+        t += dt
+        valor = tipo
+        if tipo == 2:
+            valor = dados[i] | dados[i + 1] << 8
+            i += 2
+        yield t, TIPOS[tipo], canal, valor
+
+
+def blocos(linhas):
+    """Gera (perdidos, bytes) para cada exportação GRAVACAO ... GRAVACAO_FIM."""
+    dados = None
+    perdidos = 0
+    for linha in linhas:
+        partes = linha.split()
+        if not partes:
+            continue
+        if partes[0] == "GRAVACAO" and len(partes) == 2:
+            dados, perdidos = bytearray(), int(partes[1])
+        elif partes[0] == "GRAVACAO_FIM" and dados is not None:
+            yield perdidos, bytes(dados)
+            dados = None
+        elif dados is not None:
+            try:
+                dados += bytes.fromhex(partes[0])
+            except ValueError:
+                pass  # Outra saída intercalada na serial
+
+
+def linhas_serial(caminho):
+    import serial  # pyserial
+
+    porta = serial.Serial(caminho, 115200, timeout=0.2)
+    proximo = 0.0
+    while True:
+        if time.monotonic() >= proximo:
+            porta.write(b"R")
+            proximo = time.monotonic() + 1.0
+        linha = porta.readline()
+        if linha:
+            yield linha.decode(errors="replace")
+
+
+def testar_simulador(simulador):
+    """Grava uma sessão com mais de 2^32 µs (71,6 min) entre dois toques no
+    botão A, reproduz a gravação e confere os tempos das bordas nas duas."""
+    falhas = []
+
+    def conferir(cond, msg):
+        if not cond:
+            falhas.append(msg)
+
+    # Toques de 100 ms em 20 s e em 4330 s: 4309,9 s entre o segundo e o terceiro registro
+    toques_s = (20, 4330)
+    esperados = []
+    for s in toques_s:
+        esperados += [(s * 1000000, "GPIO_BAIXO"), (s * 1000000 + 100000, "GPIO_ALTO")]
+
+    def bordas(caminho):
+        with open(caminho, "rb") as f:
+            dados = f.read()
+        conferir(dados[:4] == CABECALHO, "%s sem o cabecalho" % caminho)
+        return [(t, tipo) for t, tipo, canal, _ in registros(dados[4:]) if canal == BOTAO_A]
+
+    with tempfile.TemporaryDirectory() as d:
+        original, replay = os.path.join(d, "original.bin"), os.path.join(d, "replay.bin")
+        args = [simulador, "ocioso", str(toques_s[-1] + 10), "--gravar", original]
+        for s in toques_s:
+            args += ["--botao", str(s), str(BOTAO_A), "100"]
+        subprocess.run(args, stdout=subprocess.DEVNULL)
+        gravadas = bordas(original)
+        conferir(gravadas == esperados, "gravacao: %s, esperado %s" % (gravadas, esperados))
+
+        # O replay agenda as mesmas entradas; gravado de novo, tem que dar os mesmos tempos
+        r = subprocess.run([simulador, "replay", original, "--gravar", replay],
+                           stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, universal_newlines=True)
+        reproduzidas = bordas(replay)
+        conferir(reproduzidas == gravadas, "replay: %s, gravado %s" % (reproduzidas, gravadas))
+        print("gravacao: %d bordas do botao A, %.1f s entre os toques; %s" % (
+            len(gravadas), (toques_s[1] - toques_s[0] - 0.1), r.stderr.strip()))
+
+    for f in falhas:
+        print("FALHA:", f)
+    print("gravacao: %s" % ("FALHOU" if falhas else "OK"))
+    return 1 if falhas else 0
+
+
+def main():
+    if sys.argv[1:2] in (["-h"], ["--help"]):
+        print(__doc__)
+        return 0
+    if len(sys.argv) == 3 and sys.argv[1] == "--testar-simulador":
+        return testar_simulador(sys.argv[2])
+    if len(sys.argv) != 3 or sys.argv[1].startswith("-"):
+        print(__doc__, file=sys.stderr)
+        return 2
+    origem, destino = sys.argv[1], sys.argv[2]
+    if origem.startswith("/dev/") or origem.upper().startswith("COM"):
+        fonte = linhas_serial(origem)
+    else:
+        fonte = open(origem, errors="replace")
+
+    total = 0
+    perdidos_antes = 0
+    with open(destino, "wb") as saida:
+        saida.write(CABECALHO)
+        try:
+            for perdidos, dados in blocos(fonte):
+                saida.write(dados)
+                saida.flush()
+                total += len(dados)
+                if perdidos != perdidos_antes:
+                    print("aviso: %d registros perdidos no firmware" % perdidos, file=sys.stderr)
+                    perdidos_antes = perdidos
+        except KeyboardInterrupt:
+            pass
+    print("%d bytes gravados em %s" % (total, destino), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
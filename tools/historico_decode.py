@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+"""Decodifica o histórico de alimentações exportado pelo firmware (comando 'H').
+
+Uso:
+    python3 tools/historico_decode.py /dev/ttyACM0          # envia 'H' e lê (requer pyserial)
+    python3 tools/historico_decode.py captura.txt [--csv]
+
+Teste do histórico sobre a flash simulada (alvo verificar_historico):
+    python3 tools/historico_decode.py --testar-simulador build_host/simulador
+
+O formato está descrito em inc/historico.h: setores com cabeçalho de 16
+bytes e registros [tamanho][tipo][varints...][crc8], com tempo em deltas
+de segundos. Um registro inválido encerra a leitura do setor, como no
+firmware.
+"""
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+MAGICO = 0x31545348
+TIPOS = {0: "BOOT", 1: "ALIMENTACAO", 2: "ALERTA"}
+FLAGS = ((1, "auto"), (2, "falta_racao"), (4, "falta_agua"))
+COLUNAS = ["boot", "tempo_s", "tipo", "estacao", "flags", "racao_pedida", "racao_real", "agua_pedida", "agua_real"]
+SETOR = 4096
+SETORES = 8
+
+
+def nomes_flags(flags):
+    return "|".join(nome for bit, nome in FLAGS if flags & bit)
+
+
+def crc8(dados):
+    crc = 0
+    for b in dados:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def varints(dados):
+    valores, v, desloc = [], 0, 0
+    for b in dados:
+        v |= (b & 0x7F) << desloc
+        desloc += 7
+        if not b & 0x80:
+            valores.append(v)
+            v, desloc = 0, 0
+    return valores
+
+
+def setores(linhas):
+    """Gera (seq, bytes) de cada setor da exportação."""
+    seq, dados, dentro = None, bytearray(), False
+    for linha in linhas:
+        partes = linha.split()
+        if not partes:
+            continue
+        if partes[0] == "HISTORICO":
+            dentro = True
+        elif not dentro:
+            continue
+        elif partes[0] in ("SETOR", "HISTORICO_FIM"):
+            if seq is not None:
+                yield seq, bytes(dados)
+            if partes[0] == "HISTORICO_FIM":
+                return
+            seq, dados = int(partes[1]), bytearray()
+        else:
+            try:
+                dados += bytes.fromhex(partes[0])
+            except ValueError:
+                pass  # Outra saída intercalada na serial
+
+
+def eventos(linhas):
+    for seq, dados in setores(linhas):
+        if len(dados) < 16:
+            continue
+        magico, _, boot, tempo = struct.unpack_from("<IIII", dados)
+        if magico != MAGICO:
+            print("aviso: setor %d sem cabecalho valido" % seq, file=sys.stderr)
+            continue
+        i = 16
+        while i + 2 <= len(dados) and dados[i] != 0xFF:
+            n = dados[i]
+            if n < 1 or i + n + 2 > len(dados) or crc8(dados[i : i + n + 1]) != dados[i + n + 1]:
+                print("aviso: registro incompleto no setor %d (offset %d)" % (seq, i), file=sys.stderr)
+                break
+            tipo, campos = dados[i + 1], varints(dados[i + 2 : i + n + 1])
+            i += n + 2
+            if tipo == 0:
+                boot, tempo = campos[0], 0
+                yield {"seq": seq, "boot": boot, "tempo_s": 0, "tipo": "BOOT"}
+                continue
+            tempo += campos[0]
+            est, flags, rp, rr, ap, ar = (campos + [0] * 7)[1:7]
+            yield {
+                "seq": seq,
+                "boot": boot,
+                "tempo_s": tempo,
+                "tipo": TIPOS.get(tipo, str(tipo)),
+                "estacao": est,
+                "flags": nomes_flags(flags),
+                "racao_pedida": rp,
+                "racao_real": rr,
+                "agua_pedida": ap,
+                "agua_real": ar,
+            }
+
+
+def linhas_serial(caminho):
+    import serial  # pyserial
+
+    porta = serial.Serial(caminho, 115200, timeout=5)
+    porta.write(b"H")
+    while True:
+        linha = porta.readline().decode(errors="replace")
+        if not linha:
+            return
+        yield linha
+        if linha.startswith("HISTORICO_FIM"):
+            return
+
+
+def chave(ev):
+    """O que um evento exportado precisa reproduzir do que foi gravado."""
+    if ev["tipo"] == "BOOT":
+        return ("BOOT", ev["boot"])
+    return tuple(ev[c] for c in COLUNAS)
+
+
+def rodar(simulador, n, semente, flash, extras=()):
+    """Roda o cenário 'historico' do simulador. Devolve o código de saída, as
+    chaves do que foi gravado (o boot da montagem e cada REGISTRO) e os
+    eventos exportados."""
+    args = [simulador, "historico", str(n), str(semente), "--flash", flash] + list(extras)
+    r = subprocess.run(args, stdout=subprocess.PIPE, universal_newlines=True)
+    gravados = []
+    for linha in r.stdout.splitlines():
+        partes = linha.split()
+        if partes[:2] == ["MONTADO", "boot"]:
+            gravados.append(("BOOT", int(partes[2])))
+        elif partes[:1] == ["REGISTRO"]:
+            boot, tempo, tipo, est, flags, rp, rr, ap, ar = map(int, partes[1:10])
+            gravados.append((boot, tempo, TIPOS[tipo], est, nomes_flags(flags), rp, rr, ap, ar))
+    return r.returncode, gravados, list(eventos(r.stdout.splitlines()))
+
+
+def registros_setor(imagem, seq):
+    """Offsets dos registros do setor de sequência 'seq' na imagem da flash."""
+    for s in range(SETORES):
+        magico, seq_setor = struct.unpack_from("<II", imagem, s * SETOR)
+        if magico == MAGICO and seq_setor == seq:
+            offsets, i = [], s * SETOR + 16
+            while imagem[i] != 0xFF:
+                offsets.append(i)
+                i += imagem[i] + 2
+            return offsets
+    raise ValueError("setor %d nao encontrado" % seq)
+
+
+def testar_simulador(simulador):
+    """Grava, remonta, corta gravações e corrompe registros na flash simulada
+    e confere a exportação decodificada contra o que foi gravado."""
+    falhas = []
+
+    def conferir(cond, msg):
+        if not cond:
+            falhas.append(msg)
+
+    with tempfile.TemporaryDirectory() as d:
+        flash = os.path.join(d, "flash.bin")
+
+        # Mais eventos do que cabem nos 8 setores: a região dá a volta e os
+        # setores mais antigos são apagados; o que sobra é o fim do que foi
+        # gravado, na ordem, com tempo, pedido x real e alertas iguais
+        codigo, gravados, evs = rodar(simulador, 3000, 1, flash)
+        seqs = sorted(set(ev["seq"] for ev in evs))
+        chaves = [chave(ev) for ev in evs]
+        conferir(codigo == 0, "volta: gravacao falhou")
+        conferir(seqs == list(range(seqs[0], seqs[0] + SETORES)) and seqs[0] > 1,
+                 "volta: setores exportados %s" % seqs)
+        conferir(len(chaves) < len(gravados) and gravados[-len(chaves):] == chaves,
+                 "volta: exportacao nao e o fim do que foi gravado")
+        alertas = [ev for ev in evs if ev["tipo"] == "ALERTA"]
+        conferir(all("falta_" in ev["flags"] for ev in alertas) and
+                 all(ev["racao_real"] < ev["racao_pedida"] for ev in alertas if "falta_racao" in ev["flags"]) and
+                 all(ev["agua_real"] < ev["agua_pedida"] for ev in alertas if "falta_agua" in ev["flags"]),
+                 "volta: alerta sem a falta correspondente")
+        conferir(any("falta_racao" in ev["flags"] for ev in alertas) and
+                 any("falta_agua" in ev["flags"] for ev in alertas) and
+                 any("auto" in ev["flags"] for ev in evs), "volta: flags nao exercitados")
+        print("historico volta: %d gravados, %d exportados nos setores %d-%d" % (
+            len(gravados), len(chaves), seqs[0], seqs[-1]))
+
+        # Reboot: a montagem retoma o setor ativo com o boot seguinte; o que
+        # já estava gravado continua lá, menos um setor reaproveitado
+        codigo, gravados2, evs2 = rodar(simulador, 50, 2, flash)
+        chaves2 = [chave(ev) for ev in evs2]
+        anteriores = chaves2[: len(chaves2) - len(gravados2)]
+        conferir(codigo == 0 and gravados2[:1] == [("BOOT", 2)], "remontagem: boot %s" % gravados2[:1])
+        conferir(chaves2[-len(gravados2):] == gravados2, "remontagem: eventos novos diferentes dos gravados")
+        conferir(len(anteriores) > len(chaves) // 2 and chaves[-len(anteriores):] == anteriores,
+                 "remontagem: eventos anteriores perdidos")
+        print("historico remontagem: %d anteriores mantidos, %d novos" % (len(anteriores), len(gravados2)))
+
+        # CRC errado num registro do segundo setor mais antigo e noutro do
+        # ativo: a leitura de cada um para no registro ruim e a montagem
+        # segue num setor novo, que apaga o mais antigo
+        with open(flash, "rb") as f:
+            imagem = bytearray(f.read())
+        seqs = sorted(set(ev["seq"] for ev in evs2))
+        cortes = {seqs[1]: 10, seqs[-1]: len(registros_setor(imagem, seqs[-1])) // 2}
+        for seq, k in cortes.items():
+            i = registros_setor(imagem, seq)[k]
+            imagem[i + imagem[i] + 1] ^= 0x01
+        with open(flash, "wb") as f:
+            f.write(imagem)
+        esperados, posicao = [], {}
+        for ev in evs2:
+            k = posicao[ev["seq"]] = posicao.get(ev["seq"], -1) + 1
+            if ev["seq"] != seqs[0] and k < cortes.get(ev["seq"], k + 1):
+                esperados.append(chave(ev))
+        codigo, gravados3, evs3 = rodar(simulador, 0, 3, flash)
+        conferir(codigo == 0 and [chave(ev) for ev in evs3] == esperados + gravados3,
+                 "crc: registros invalidos nao foram ignorados")
+        conferir(evs3[-1]["seq"] == seqs[-1] + 1, "crc: montagem nao seguiu no setor seguinte")
+        print("historico crc: registros %s ignorados, %d exportados" % (cortes, len(evs3)))
+
+        # Escrita cortada ao meio (queda de energia): o registro não confere,
+        # o setor é encerrado e o registro vai inteiro para o próximo; uma
+        # nova montagem continua nele
+        os.remove(flash)
+        codigo, gravados4, evs4 = rodar(simulador, 40, 3, flash, ["--falhar-escrita", "20"])
+        conferir(codigo == 0 and [chave(ev) for ev in evs4] == gravados4, "escrita cortada: eventos perdidos ou errados")
+        conferir(sorted(set(ev["seq"] for ev in evs4)) == [1, 2], "escrita cortada: registro nao foi para o setor seguinte")
+        codigo, gravados5, evs5 = rodar(simulador, 5, 4, flash)
+        conferir(codigo == 0 and [chave(ev) for ev in evs5] == gravados4 + gravados5 and evs5[-1]["seq"] == 2,
+                 "escrita cortada: remontagem nao continuou no setor seguinte")
+        print("historico escrita cortada: %d eventos, %d no setor 1" % (
+            len(evs5), sum(ev["seq"] == 1 for ev in evs5)))
+
+    for f in falhas:
+        print("FALHA:", f)
+    print("historico: %s" % ("FALHOU" if falhas else "OK"))
+    return 1 if falhas else 0
+
+
+def main():
+    args = [a for a in sys.argv[1:] if a != "--csv"]
+    csv = "--csv" in sys.argv
+    if args[:1] in (["-h"], ["--help"]):
+        print(__doc__)
+        return 0
+    if len(args) == 2 and args[0] == "--testar-simulador":
+        return testar_simulador(args[1])
+    if len(args) != 1 or args[0].startswith("-"):
+        print(__doc__, file=sys.stderr)
+        return 2
+    if args[0].startswith("/dev/") or args[0].upper().startswith("COM"):
+        fonte = linhas_serial(args[0])
+    else:
+        fonte = open(args[0], errors="replace")
+
+    if csv:
+        print(",".join(COLUNAS))
+    for ev in eventos(fonte):
+        if csv:
+            print(",".join(str(ev.get(c, "")) for c in COLUNAS))
+        elif ev["tipo"] == "BOOT":
+            print("boot %d" % ev["boot"])
+        else:
+            print(
+                "boot %(boot)d t=%(tempo_s)6ds %(tipo)-11s est=%(estacao)d racao %(racao_real)d/%(racao_pedida)d g"
+                " agua %(agua_real)d/%(agua_pedida)d ml %(flags)s" % ev
+            )
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""Cliente do protocolo binário de controle (inc/protocolo.h).
+
+Uso com a placa (requer pyserial):
+    python3 tools/protocolo.py /dev/ttyACM0 ping
+    python3 tools/protocolo.py /dev/ttyACM0 ler
+    python3 tools/protocolo.py /dev/ttyACM0 definir racao=80 agua=40 intervalo=6 auto=1
+    python3 tools/protocolo.py /dev/ttyACM0 alimentar
+    python3 tools/protocolo.py /dev/ttyACM0 telemetria 500      # 0 desliga
+
+Teste contra o simulador do host (host/, alvo verificar_protocolo):
+    python3 tools/protocolo.py --testar-simulador build_host/simulador
+
+Os bytes de texto (log diferido, relatórios) que chegam entre os quadros
+são ignorados pelo leitor.
+"""
+import struct
+import subprocess
+import sys
+import tempfile
+
+SOF = 0xA5
+PING, DEFINIR, LER, TELEMETRIA_PERIODO, ALIMENTAR = 0x01, 0x02, 0x03, 0x04, 0x05
+RESPOSTA, TELEMETRIA, ERRO = 0x80, 0x90, 0xFF
+STATUS = {0: "ok", 1: "tipo desconhecido", 2: "tamanho invalido", 3: "campo invalido", 4: "valor invalido"}
+CAMPOS = {"racao": 1, "agua": 2, "intervalo": 3, "auto": 4, "estoque_racao": 5, "estoque_agua": 6, "tempo_ms": 7}
+NOMES = {v: k for k, v in CAMPOS.items()}
+
+
+def crc16(dados):
+    crc = 0xFFFF
+    for b in dados:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def quadro(tipo, seq, payload=b""):
+    corpo = bytes([len(payload), tipo, seq]) + payload
+    return bytes([SOF]) + corpo + struct.pack("<H", crc16(corpo))
+
+
+def campos(valores):
+    """{nome ou id: valor} -> payload de DEFINIR."""
+    return b"".join(struct.pack("<Bi", CAMPOS.get(c, c), v) for c, v in valores.items())
+
+
+def ler_campos(payload):
+    return {NOMES.get(payload[i], payload[i]): struct.unpack_from("<i", payload, i + 1)[0] for i in range(0, len(payload) - 4, 5)}
+
+
+class Leitor:
+    """Separa quadros válidos do resto do fluxo da serial."""
+
+    def __init__(self):
+        self.buf = bytearray()
+
+    def alimentar(self, dados):
+        self.buf += dados
+        quadros = []
+        while True:
+            i = self.buf.find(SOF)
+            if i < 0:
+                self.buf.clear()
+                return quadros
+            del self.buf[:i]
+            if len(self.buf) < 2:
+                return quadros
+            n = self.buf[1] + 6
+            if self.buf[1] > 64:
+                del self.buf[:1]
+                continue
+            if len(self.buf) < n:
+                return quadros
+            q = bytes(self.buf[:n])
+            if crc16(q[1:-2]) == struct.unpack("<H", q[-2:])[0]:
+                quadros.append((q[2], q[3], q[4:-2]))
+                del self.buf[:n]
+            else:
+                del self.buf[:1]
+
+
+def descrever(tipo, seq, payload):
+    if tipo == TELEMETRIA:
+        return "telemetria #%d %s" % (seq, ler_campos(payload))
+    status = STATUS.get(payload[0], payload[0]) if payload else "?"
+    if tipo == LER | RESPOSTA and payload[0] == 0:
+        return "seq %d: %s" % (seq, ler_campos(payload[1:]))
+    return "seq %d: tipo 0x%02x %s %s" % (seq, tipo, status, payload[1:].hex())
+
+
+def executar(porta, args):
+    import serial  # pyserial
+
+    s = serial.Serial(porta, 115200, timeout=0.2)
+    leitor = Leitor()
+    cmd = args[0]
+    if cmd == "ping":
+        s.write(quadro(PING, 1))
+    elif cmd == "ler":
+        s.write(quadro(LER, 1))
+    elif cmd == "definir":
+        valores = {}
+        for a in args[1:]:
+            nome, valor = a.split("=")
+            valores[nome] = int(valor)
+        s.write(quadro(DEFINIR, 1, campos(valores)))
+    elif cmd == "alimentar":
+        s.write(quadro(ALIMENTAR, 1))
+    elif cmd == "telemetria":
+        s.write(quadro(TELEMETRIA_PERIODO, 1, struct.pack("<H", int(args[1]))))
+    else:
+        print(__doc__, file=sys.stderr)
+        return 2
+
+    # Mostra a resposta; com a telemetria ligada, segue mostrando até Ctrl+C
+    try:
+        while True:
+            for q in leitor.alimentar(s.read(256)):
+                print(descrever(*q))
+                if q[0] != TELEMETRIA and cmd != "telemetria":
+                    return 0
+    except KeyboardInterrupt:
+        return 0
+
+
+def testar_simulador(simulador):
+    """Envia pedidos ao simulador pela serial virtual e confere as respostas."""
+    pedidos = [
+        (4.0, quadro(PING, 1)),
+        (4.5, quadro(DEFINIR, 2, campos({"racao": 80, "agua": 40, "intervalo": 9, "auto": 1, "estoque_racao": 900, "estoque_agua": 800}))),
+        (5.0, quadro(LER, 3)),
+        # Lote com um valor inválido no fim: nada deve ser aplicado
+        (5.5, quadro(DEFINIR, 4, campos({"agua": 10, "racao": 9999}))),
+        (6.0, quadro(LER, 5)),
+        # CRC corrompido (sem resposta), seguido de um tipo desconhecido
+        (6.5, quadro(PING, 6)[:-1] + b"\x00" + quadro(0x33, 7)),
+        (7.0, quadro(TELEMETRIA_PERIODO, 8, struct.pack("<H", 100))),
+        (9.0, quadro(TELEMETRIA_PERIODO, 9, struct.pack("<H", 0))),
+        (10.0, quadro(ALIMENTAR, 10)),
+    ]
+    args = [simulador, "ocioso", "25"]
+    with tempfile.TemporaryDirectory() as d:
+        for i, (t, q) in enumerate(pedidos):
+            caminho = "%s/q%d.bin" % (d, i)
+            with open(caminho, "wb") as f:
+                f.write(q)
+            args += ["--serial", str(t), caminho]
+        saida = subprocess.run(args, stdout=subprocess.PIPE, check=True).stdout
+
+    respostas, telemetria = {}, []
+    for tipo, seq, payload in Leitor().alimentar(saida):
+        if tipo == TELEMETRIA:
+            telemetria.append(ler_campos(payload))
+        else:
+            respostas[seq] = (tipo, payload)
+
+    falhas = []
+
+    def conferir(cond, msg):
+        if not cond:
+            falhas.append(msg)
+
+    conferir(respostas.get(1) == (PING | RESPOSTA, bytes([0, 1])), "ping")
+    conferir(respostas.get(2) == (DEFINIR | RESPOSTA, bytes([0, 6])), "definir em lote")
+    lido = ler_campos(respostas.get(3, (0, b"\0"))[1][1:])
+    esperado = {"racao": 80, "agua": 40, "intervalo": 9, "auto": 1, "estoque_racao": 900, "estoque_agua": 800}
+    conferir(all(lido.get(k) == v for k, v in esperado.items()), "leitura apos definir: %s" % lido)
+    conferir(respostas.get(4) == (DEFINIR | RESPOSTA, bytes([4, 1])), "lote invalido recusado no campo 1")
+    lido = ler_campos(respostas.get(5, (0, b"\0"))[1][1:])
+    conferir(lido.get("agua") == 40 and lido.get("racao") == 80, "lote invalido nao aplicado: %s" % lido)
+    conferir(6 not in respostas, "quadro com CRC invalido respondido")
+    conferir(respostas.get(7) == (ERRO, bytes([1, 0x33])), "tipo desconhecido")
+    conferir(respostas.get(8) == (TELEMETRIA_PERIODO | RESPOSTA, bytes([0, 0])), "periodo da telemetria")
+    conferir(respostas.get(10) == (ALIMENTAR | RESPOSTA, bytes([0, 0])), "alimentar")
+
+    # 100 ms entre 7 s e 9 s: cerca de 20 retratos, nenhum depois de desligar
+    tempos = [t["tempo_ms"] for t in telemetria]
+    conferir(18 <= len(tempos) <= 22, "telemetria: %d retratos em 2 s" % len(tempos))
+    conferir(all(7000 <= t <= 9100 for t in tempos), "telemetria fora da janela: %s" % tempos[-3:])
+    intervalos = [b - a for a, b in zip(tempos, tempos[1:])]
+    conferir(all(80 <= i <= 120 for i in intervalos), "periodo da telemetria: %s" % intervalos)
+
+    for f in falhas:
+        print("FALHA:", f)
+    print("protocolo: %d respostas, %d retratos de telemetria, %s" % (len(respostas), len(tempos), "FALHOU" if falhas else "OK"))
+    return 1 if falhas else 0
+
+
+def main():
+    if len(sys.argv) == 3 and sys.argv[1] == "--testar-simulador":
+        return testar_simulador(sys.argv[2])
+    if len(sys.argv) < 3:
+        print(__doc__, file=sys.stderr)
+        return 2
+    return executar(sys.argv[1], sys.argv[2:])
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Lista os símbolos de float, double e libm presentes num ELF do firmware.
+
+Uso:
+    python3 tools/simbolos_float.py build/Projeto_Final.elf
+    python3 tools/simbolos_float.py --nm arm-none-eabi-nm --nenhum build/Projeto_Final.elf
+
+Mostra cada símbolo com o tamanho e o total em bytes de flash. Com
+--nenhum, sai com código 1 se houver algum (verificação do perfil
+PERFIL_INTEIRO, chamada pelo CMake após o link). Para medir a economia,
+compile com -DPERFIL_INTEIRO=OFF e ON e compare a saída deste script e a
+de arm-none-eabi-size.
+"""
+import re
+import subprocess
+import sys
+
+# Rotinas de soft-float da libgcc/AEABI, wrappers do pico_float/pico_double,
+# funções da libm e o printf com suporte a float
+PADROES = re.compile(
+    r"^(__wrap_)?("
+    r"__aeabi_(f|d|[iul]2[fd]|[fd]2)\w*"
+    r"|__(add|sub|mul|div|neg|cmp|eq|ne|lt|le|gt|ge|unord)[sd]f[23]"
+    r"|__(fix|fixuns|float|floatun)\w*[sd]f\w*"
+    r"|__(extend|trunc)[sd]f[sd]f2"
+    r"|(ceil|floor|round|trunc|sqrt|pow|exp|log|sin|cos|tan|atan2?|fmod|ldexp|frexp|modf)f?"
+    r"|_?(float|double)_table\w*"
+    r"|__aeabi_float_init|__aeabi_double_init"
+    r"|_(ftoa|etoa)"
+    r")$"
+)
+
+
+def simbolos(nm, elf):
+    saida = subprocess.run([nm, "-S", "--size-sort", elf], stdout=subprocess.PIPE, check=True, text=True).stdout
+    achados = []
+    for linha in saida.splitlines():
+        partes = linha.split()
+        if len(partes) == 4 and PADROES.match(partes[3]):
+            achados.append((partes[3], int(partes[1], 16)))
+    return achados
+
+
+def main():
+    args = sys.argv[1:]
+    nm, nenhum = "arm-none-eabi-nm", False
+    if "--nm" in args:
+        i = args.index("--nm")
+        nm = args[i + 1]
+        del args[i : i + 2]
+    if "--nenhum" in args:
+        args.remove("--nenhum")
+        nenhum = True
+    if len(args) != 1:
+        print(__doc__, file=sys.stderr)
+        return 2
+
+    achados = simbolos(nm, args[0])
+    for nome, tamanho in sorted(achados, key=lambda s: -s[1]):
+        print("%6d %s" % (tamanho, nome))
+    print("%d simbolos de float/libm, %d bytes" % (len(achados), sum(t for _, t in achados)))
+    return 1 if nenhum and achados else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Converte a exportação de trace_exportar() para o formato de trace do Chrome.
+
+Uso:
+    python3 tools/trace2json.py captura.txt > trace.json
+    python3 tools/trace2json.py /dev/ttyACM0 > trace.json   # envia 'T' e lê (requer pyserial)
+
+Abra o trace.json em chrome://tracing ou https://ui.perfetto.dev.
+Os nomes dos eventos vêm de inc/trace_ids.h.
+"""
+import json
+import os
+import re
+import sys
+
+RAIZ = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def carregar_nomes(caminho=os.path.join(RAIZ, "inc", "trace_ids.h")):
+    with open(caminho, encoding="utf-8") as f:
+        return re.findall(r'X\(\s*TRACE_\w+\s*,\s*"([^"]*)"\s*\)', f.read())
+
+
+def linhas(origem):
+    if origem.startswith("/dev/") or origem.upper().startswith("COM"):
+        import serial  # pyserial
+
+        porta = serial.Serial(origem, 115200, timeout=5)
+        porta.write(b"T")
+        while True:
+            linha = porta.readline().decode(errors="replace")
+            if not linha:
+                return
+            yield linha
+            if linha.startswith("TRACE_FIM"):
+                return
+    else:
+        with open(origem, errors="replace") as f:
+            yield from f
+
+
+def converter(fonte, nomes):
+    eventos = []
+    dentro = False
+    for linha in fonte:
+        partes = linha.split()
+        if not partes:
+            continue
+        if partes[0] == "TRACE_INICIO":
+            dentro = True
+        elif partes[0] == "TRACE_FIM":
+            dentro = False
+        elif partes[0] == "TRACE_SOBRESCRITOS":
+            print("aviso: nucleo %s perdeu %s eventos" % (partes[1], partes[2]), file=sys.stderr)
+        elif dentro and partes[0] == "T" and len(partes) == 6:
+            nucleo, tipo, ident, tempo, valor = int(partes[1]), partes[2], int(partes[3]), int(partes[4]), int(partes[5])
+            nome = nomes[ident] if ident < len(nomes) else "id_%d" % ident
+            ev = {"name": nome, "ph": tipo, "ts": tempo, "pid": 0, "tid": nucleo}
+            if tipo == "C":
+                ev["args"] = {nome: valor}
+            elif tipo == "i":
+                ev["s"] = "t"
+            eventos.append(ev)
+    # Cada núcleo é exportado em bloco; o visualizador espera ordem por tempo
+    eventos.sort(key=lambda e: e["ts"])
+    base = eventos[0]["ts"] if eventos else 0
+    for ev in eventos:
+        ev["ts"] -= base
+    meta = [{"name": "thread_name", "ph": "M", "pid": 0, "tid": n, "args": {"name": "core%d" % n}} for n in (0, 1)]
+    return {"traceEvents": meta + eventos, "displayTimeUnit": "ms"}
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__, file=sys.stderr)
+        return 2
+    json.dump(converter(linhas(sys.argv[1]), carregar_nomes()), sys.stdout, indent=1)
+    print()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())